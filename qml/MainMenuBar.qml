@@ -1,8 +1,13 @@
+import Blockstream.Green.Core 0.1
 import Blockstream.Green.Gui 0.1
 
 MenuBar {
     window: main_window
 
+    Component.onCompleted: {
+        if (Qt.application.arguments.indexOf('--debugtrace') > 0) addMenu(debug_menu.createObject(window))
+    }
+
     Menu {
         title: qsTrId('&File')
 
@@ -37,4 +42,15 @@ MenuBar {
             onTriggered: Qt.openUrlExternally(constants.supportUrl)
         }
     }
+
+    Component {
+        id: debug_menu
+        Menu {
+            title: 'Debug'
+            Action {
+                text: 'Export trace'
+                onTriggered: if (Tracer.exportTrace()) Qt.openUrlExternally(data_dir + '/logs')
+            }
+        }
+    }
 }
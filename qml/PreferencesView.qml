@@ -154,6 +154,16 @@ MainPage {
                     }
                     HSpacer {
                     }
+                    Label {
+                        text: 'Connect recent wallets at startup'
+                    }
+                    GSwitch {
+                        Layout.alignment: Qt.AlignLeft
+                        checked: Settings.prewarmSessions
+                        onCheckedChanged: Settings.prewarmSessions = checked
+                    }
+                    HSpacer {
+                    }
                 }
             }
             MainPageSection {
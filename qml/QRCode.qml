@@ -16,6 +16,6 @@ Item {
         anchors.centerIn: parent
         sourceSize.width: parent.implicitWidth
         sourceSize.height: parent.implicitHeight
-        source: `image://QZXing/encode/${escape(text || '')}?format=qrcode&border=true&transparent=true`
+        source: `image://qrcode/${encodeURIComponent(text || '')}`
     }
 }
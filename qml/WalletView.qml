@@ -34,8 +34,7 @@ MainPage {
     }
 
     function transactionConfirmations(transaction) {
-        if (transaction.data.block_height === 0) return 0;
-        return 1 + transaction.account.wallet.events.block.block_height - transaction.data.block_height;
+        return transaction.confirmations;
     }
 
     function transactionStatus(confirmations) {
@@ -2,22 +2,34 @@
 #include "address.h"
 #include "asset.h"
 #include "balance.h"
+#include "confirmationtracker.h"
 #include "ga.h"
 #include "handlers/getbalancehandler.h"
+#include "handlers/gettransactionshandler.h"
 #include "json.h"
 #include "network.h"
 #include "resolver.h"
 #include "output.h"
+#include "receiveaddresspool.h"
 #include "transaction.h"
 #include "wallet.h"
 
 #include <gdk.h>
 
+namespace {
+    bool BalanceLessThan(const Balance* b1, const Balance* b2)
+    {
+        return b1->asset()->sortKey() < b2->asset()->sortKey();
+    }
+} // namespace
+
 Account::Account(const QJsonObject& data, Wallet* wallet)
     : QObject(wallet)
     , m_wallet(wallet)
     , m_pointer(data.value("pointer").toInt())
     , m_type(data.value("type").toString())
+    , m_confirmation_tracker(new ConfirmationTracker(this))
+    , m_receive_address_pool(new ReceiveAddressPool(this))
 {
     Q_ASSERT(m_pointer >= 0);
     Q_ASSERT(!m_type.isEmpty());
@@ -40,65 +52,81 @@ void Account::update(const QJsonObject& json)
 
 void Account::updateBalance()
 {
-    if (wallet()->network()->isLiquid()) {
-        auto satoshi = m_json.value("satoshi").toObject();
-        auto balance_by_id = m_balance_by_id;
-        m_balance_by_id.clear();
-        m_balances.clear();
-        for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
-            Balance* balance = balance_by_id.take(i.key());
-            if (!balance) balance = new Balance(this);
-            m_balance_by_id.insert(i.key(), balance);
-            balance->setAsset(wallet()->getOrCreateAsset(i.key()));
-            balance->setAmount(i.value().toDouble());
+    const bool liquid = wallet()->network()->isLiquid();
+    const auto satoshi = m_json.value("satoshi").toObject();
+    auto previous = m_amounts;
+    bool changed = false;
+    bool balances_changed = false;
+    m_amounts.clear();
+    for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
+        const QString id = i.key();
+        const qint64 amount = i.value().toDouble();
+        const bool known = previous.contains(id);
+        const qint64 last = previous.take(id);
+        m_amounts.insert(id, amount);
+        if (amount != last) {
+            m_wallet->updateTotal(id, last, amount);
+            changed = true;
+        }
+        if (!liquid) continue;
+        if (known) {
+            m_balance_by_id.value(HashKey::fromString(id))->setAmount(amount);
+        } else {
+            Balance* balance = new Balance(this);
+            balance->setAsset(wallet()->getOrCreateAsset(id));
+            balance->setAmount(amount);
+            m_balance_by_id.insert(HashKey::fromString(id), balance);
             m_balances.append(balance);
+            balances_changed = true;
         }
-        std::sort(m_balances.begin(), m_balances.end(), [](const Balance* b1, const Balance* b2) {
-            Asset* a1 = b1->asset();
-            Asset* a2 = b2->asset();
-
-            if (a1->isLBTC()) return true;
-            if (a2->isLBTC()) return false;
-
-            if (a1->hasIcon() && !a2->hasIcon()) return true;
-            if (a2->hasIcon() && !a1->hasIcon()) return false;
-            if (a1->hasIcon() && a2->hasIcon()) return a1->name() < a2->name();
-
-            if (a1->hasData() && !a2->hasData()) return true;
-            if (a2->hasData() && !a1->hasData()) return false;
-            if (a1->hasData() && a2->hasData()) return a1->name() < a2->name();
+    }
+    for (auto i = previous.constBegin(); i != previous.constEnd(); ++i) {
+        if (i.value() != 0) {
+            m_wallet->updateTotal(i.key(), i.value(), 0);
+            changed = true;
+        }
+        if (!liquid) continue;
+        Balance* balance = m_balance_by_id.take(HashKey::fromString(i.key()));
+        m_balances.removeOne(balance);
+        delete balance;
+        balances_changed = true;
+    }
 
-            return a1->name() < a2->name();
-        });
+    if (balances_changed) {
+        std::sort(m_balances.begin(), m_balances.end(), BalanceLessThan);
         emit balancesChanged();
-        qDeleteAll(balance_by_id.values());
     }
+    if (changed) emit balanceChanged();
+}
 
-    emit balanceChanged();
+void Account::sortBalances()
+{
+    const auto balances = m_balances;
+    std::sort(m_balances.begin(), m_balances.end(), BalanceLessThan);
+    if (m_balances != balances) emit balancesChanged();
 }
 
-void Account::handleNotification(const QJsonObject& notification)
+void Account::handleTransactionEvent(const TransactionEvent& event)
 {
-    const auto event = notification.value("event").toString();
-    if (event == "transaction") {
+    reload();
+    emit transactionEvent(event);
+}
+
+void Account::handleBlockEvent(const BlockEvent& event)
+{
+    // FIXME: Until gdk notifies of chain reorgs, resync balance every
+    // 10 blocks in case a reorged tx is somehow evicted from the mempool
+    if (!wallet()->network()->isLiquid() || (event.height % 10) == 0) {
         reload();
-        emit notificationHandled(notification);
-    } else if (event == "block") {
-        // FIXME: Until gdk notifies of chain reorgs, resync balance every
-        // 10 blocks in case a reorged tx is somehow evicted from the mempool
-        const auto block = notification.value("block").toObject();
-        uint32_t block_height = block.value("block_height").toDouble();
-        if (!wallet()->network()->isLiquid() || (block_height % 10) == 0) {
-            reload();
-        }
-        emit notificationHandled(notification);
     }
+    m_confirmation_tracker->update(event.height);
+    emit blockEvent(event);
 }
 
 qint64 Account::balance() const
 {
     const QString key = m_wallet->network()->isLiquid() ? m_wallet->network()->policyAsset() : "btc";
-    return m_json.value("satoshi").toObject().value(key).toDouble();
+    return m_amounts.value(key);
 }
 
 QQmlListProperty<Balance> Account::balances()
@@ -121,6 +149,62 @@ void Account::reload()
     handler->exec();
 }
 
+void Account::resync(quint32 since_height)
+{
+    auto handler = new GetBalanceHandler(this);
+    connect(handler, &Handler::done, this, [this, handler, since_height] {
+        handler->deleteLater();
+        auto balance = handler->result().value("result").toObject();
+        if (balance != m_json.value("satoshi").toObject()) {
+            m_json.insert("satoshi", balance);
+            emit jsonChanged();
+            updateBalance();
+            // Unknown transactions changed, subscribers refetch.
+            emit transactionEvent({});
+            return;
+        }
+        // Transactions confirmed while disconnected don't move the balance.
+        resyncTransactions(since_height);
+    });
+    connect(handler, &Handler::error, handler, &QObject::deleteLater);
+    QObject::connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
+        resolver->resolve();
+    });
+    handler->exec();
+}
+
+void Account::resyncTransactions(quint32 since_height)
+{
+    // Newest first, unconfirmed included, a page is enough unless many
+    // transactions happened while disconnected.
+    const int count = 30;
+    auto handler = new GetTransactionsHandler(m_pointer, 0, count, m_wallet);
+    connect(handler, &Handler::done, this, [this, handler, since_height, count] {
+        handler->deleteLater();
+        const auto transactions = handler->transactions();
+        bool changed = transactions.size() == count;
+        for (const QJsonValue& value : transactions) {
+            const auto data = value.toObject();
+            const quint32 block_height = data.value("block_height").toDouble();
+            // Confirmed before disconnecting, neither it nor older ones changed.
+            if (block_height > 0 && block_height <= since_height) {
+                changed = false;
+                break;
+            }
+            auto transaction = getTransactionByTxHash(data.value("txhash").toString());
+            if (!transaction || transaction->blockHeight() != block_height) changed = true;
+            // Known transactions are updated in place.
+            getOrCreateTransaction(data);
+        }
+        if (changed) emit transactionEvent({});
+    });
+    connect(handler, &Handler::error, handler, &QObject::deleteLater);
+    QObject::connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
+        resolver->resolve();
+    });
+    handler->exec();
+}
+
 void Account::rename(QString name, bool active_focus)
 {
     if (!active_focus) name = name.trimmed();
@@ -138,27 +222,28 @@ void Account::rename(QString name, bool active_focus)
 
 Transaction* Account::getOrCreateTransaction(const QJsonObject& data)
 {
-    auto hash = data.value("txhash").toString();
+    const auto hash = HashKey::fromString(data.value("txhash").toString());
     auto transaction = m_transactions_by_hash.value(hash);
     if (!transaction) {
         transaction = new Transaction(this);
         m_transactions_by_hash.insert(hash, transaction);
     }
     transaction->updateFromData(data);
+    m_confirmation_tracker->track(transaction);
     return transaction;
 }
 
 Output* Account::getOrCreateOutput(const QJsonObject& data)
 {
-    auto txhash = data.value("txhash").toString();
-    auto pt_idx = data.value("pt_idx").toInt();
-    auto output = m_outputs_by_hash.value(QPair<QString,int>(txhash, pt_idx));
+    const auto key = qMakePair(HashKey::fromString(data.value("txhash").toString()), data.value("pt_idx").toInt());
+    auto output = m_outputs_by_hash.value(key);
     if (!output) {
         output = new Output(data, this);
-        m_outputs_by_hash.insert(QPair<QString,int>(txhash, pt_idx), output);
+        m_outputs_by_hash.insert(key, output);
     } else {
         output->updateFromData(data);
     }
+    m_confirmation_tracker->track(output);
     return output;
 }
 
@@ -176,12 +261,12 @@ Address* Account::getOrCreateAddress(const QJsonObject& data)
 
 Balance *Account::getBalanceByAssetId(const QString &id) const
 {
-    return m_balance_by_id.value(id);
+    return m_balance_by_id.value(HashKey::fromString(id));
 }
 
 Transaction *Account::getTransactionByTxHash(const QString &id) const
 {
-    return m_transactions_by_hash.value(id);
+    return m_transactions_by_hash.value(HashKey::fromString(id));
 }
 
 bool Account::isMainAccount() const
@@ -203,8 +288,6 @@ AccountActivity::AccountActivity(Account* account, QObject* parent)
 
 }
 
-#include "handlers/gettransactionshandler.h"
-
 AccountGetTransactionsActivity::AccountGetTransactionsActivity(Account* account, int first, int count, QObject* parent)
     : AccountActivity(account, parent)
     , m_first(first)
@@ -215,9 +298,11 @@ AccountGetTransactionsActivity::AccountGetTransactionsActivity(Account* account,
 void AccountGetTransactionsActivity::exec()
 {
     auto handler = new GetTransactionsHandler(account()->pointer(), m_first, m_count, wallet());
+    handler->setBackground(m_background);
 
     QObject::connect(handler, &Handler::done, this, [this, handler] {
         handler->deleteLater();
+        if (status() == Status::Cancelled) return;
         // instantiate missing transactions
         for (const QJsonValue& value : handler->transactions()) {
             auto transaction = account()->getOrCreateTransaction(value.toObject());
@@ -233,6 +318,19 @@ void AccountGetTransactionsActivity::exec()
     handler->exec();
 }
 
+QString AccountGetTransactionsActivity::key() const
+{
+    if (!account()) return {};
+    return QString("transactions:%1:%2:%3").arg(account()->pointer()).arg(m_first).arg(m_count);
+}
+
+void AccountGetTransactionsActivity::adopt(Activity* other)
+{
+    auto activity = qobject_cast<AccountGetTransactionsActivity*>(other);
+    Q_ASSERT(activity);
+    m_transactions = activity->m_transactions;
+}
+
 #include "handlers/getunspentoutputshandler.h"
 
 AccountGetUnspentOutputsActivity::AccountGetUnspentOutputsActivity(Account* account, int num_confs, bool all_coins, QObject* parent)
@@ -248,6 +346,7 @@ void AccountGetUnspentOutputsActivity::exec()
 
     QObject::connect(handler, &Handler::done, this, [this, handler] {
         handler->deleteLater();
+        if (status() == Status::Cancelled) return;
         for (const QJsonValue& assets_values : handler->unspentOutputs()) {
             for (const QJsonValue& asset_value : assets_values.toArray()) {
                 auto output = account()->getOrCreateOutput(asset_value.toObject());
@@ -263,3 +362,16 @@ void AccountGetUnspentOutputsActivity::exec()
 
     handler->exec();
 }
+
+QString AccountGetUnspentOutputsActivity::key() const
+{
+    if (!account()) return {};
+    return QString("unspent_outputs:%1:%2:%3").arg(account()->pointer()).arg(m_num_confs).arg(int(m_all_coins));
+}
+
+void AccountGetUnspentOutputsActivity::adopt(Activity* other)
+{
+    auto activity = qobject_cast<AccountGetUnspentOutputsActivity*>(other);
+    Q_ASSERT(activity);
+    m_outputs = activity->m_outputs;
+}
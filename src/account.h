@@ -1,6 +1,8 @@
 #ifndef GREEN_ACCOUNT_H
 #define GREEN_ACCOUNT_H
 
+#include "hashkey.h"
+#include "notificationbus.h"
 #include "wallet.h"
 
 #include <QtQml>
@@ -9,6 +11,8 @@
 QT_FORWARD_DECLARE_CLASS(Address)
 QT_FORWARD_DECLARE_CLASS(Output)
 QT_FORWARD_DECLARE_CLASS(Balance)
+QT_FORWARD_DECLARE_CLASS(ConfirmationTracker)
+QT_FORWARD_DECLARE_CLASS(ReceiveAddressPool)
 QT_FORWARD_DECLARE_CLASS(Transaction)
 QT_FORWARD_DECLARE_CLASS(Wallet)
 
@@ -28,6 +32,8 @@ public:
     explicit Account(const QJsonObject& data, Wallet* wallet);
 
     Wallet* wallet() const { return m_wallet; }
+    ConfirmationTracker* confirmationTracker() const { return m_confirmation_tracker; }
+    ReceiveAddressPool* receiveAddressPool() const { return m_receive_address_pool; }
     int pointer() const { return m_pointer; }
     QString type() const { return m_type; }
     bool isMainAccount() const;
@@ -38,13 +44,18 @@ public:
 
     void update(const QJsonObject& json);
 
-    void handleNotification(const QJsonObject& notification);
+    void handleTransactionEvent(const TransactionEvent& event);
+    void handleBlockEvent(const BlockEvent& event);
 
     qint64 balance() const;
 
     QQmlListProperty<Balance> balances();
 
+    // Applies the difference between the last and the current satoshi
+    // amounts, balances of unchanged assets are left untouched.
     void updateBalance();
+    // Restores the order of balances after asset data changed.
+    void sortBalances();
     Transaction *getOrCreateTransaction(const QJsonObject &data);
     Output *getOrCreateOutput(const QJsonObject &data);
     Address *getOrCreateAddress(const QJsonObject &data);
@@ -56,21 +67,31 @@ signals:
     void nameChanged(const QString& name);
     void balanceChanged();
     void balancesChanged();
-    void notificationHandled(const QJsonObject& notification);
+    void transactionEvent(const TransactionEvent& event);
+    void blockEvent(const BlockEvent& event);
 public slots:
     void reload();
+    // Refetches the balance and, if unchanged, the transactions newer than
+    // the given height or unconfirmed. Subscribers are only notified when
+    // something changed.
+    void resync(quint32 since_height);
     void rename(QString name, bool active_focus);
 private:
+    void resyncTransactions(quint32 since_height);
     Wallet* const m_wallet;
     const int m_pointer;
     const QString m_type;
+    ConfirmationTracker* const m_confirmation_tracker;
+    ReceiveAddressPool* const m_receive_address_pool;
     QJsonObject m_json;
     QString m_name;
-    QMap<QString, Transaction*> m_transactions_by_hash;
-    QMap<QPair<QString, int>, Output*> m_outputs_by_hash;
+    QHash<HashKey, Transaction*> m_transactions_by_hash;
+    QHash<QPair<HashKey, int>, Output*> m_outputs_by_hash;
     QMap<QString, Address*> m_address_by_hash;
     QList<Balance*> m_balances;
-    QMap<QString, Balance*> m_balance_by_id;
+    QHash<HashKey, Balance*> m_balance_by_id;
+    // Amounts by asset id as of the last updateBalance.
+    QHash<QString, qint64> m_amounts;
     friend class Wallet;
 };
 
@@ -93,10 +114,15 @@ class AccountGetTransactionsActivity : public AccountActivity
 public:
     AccountGetTransactionsActivity(Account* account, int first, int count, QObject* parent);
     void exec() override;
+    QString key() const override;
+    void adopt(Activity* other) override;
+    int count() const { return m_count; }
     QVector<Transaction*> transactions() const { return m_transactions; }
+    void setBackground(bool background) { m_background = background; }
 private:
     const int m_first;
     const int m_count;
+    bool m_background{false};
     QVector<Transaction*> m_transactions;
 };
 
@@ -107,6 +133,8 @@ class AccountGetUnspentOutputsActivity : public AccountActivity
 public:
     AccountGetUnspentOutputsActivity(Account* account, int m_num_confs, bool all_coins, QObject* parent);
     void exec() override;
+    QString key() const override;
+    void adopt(Activity* other) override;
     QVector<Output*> outputs() const { return m_outputs; }
 private:
     const int m_num_confs;
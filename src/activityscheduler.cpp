@@ -0,0 +1,199 @@
+#include "activityscheduler.h"
+
+#include <QDebug>
+#include <QJsonObject>
+
+#include <algorithm>
+
+ActivityScheduler::ActivityScheduler(int max_running, QObject* parent)
+    : QObject(parent)
+    , m_max_running(max_running)
+{
+    m_clock.start();
+}
+
+ActivityScheduler::~ActivityScheduler()
+{
+    if (!m_stats.isEmpty()) qDebug() << "activity stats" << stats();
+}
+
+void ActivityScheduler::schedule(Activity* activity, Priority priority, const QList<Activity*>& dependencies)
+{
+    Q_ASSERT(activity->status() == Activity::Status::Pending);
+    auto& stats = m_stats[activity->type()];
+    stats.scheduled ++;
+
+    connect(activity, &Activity::statusChanged, this, [this, activity](Activity::Status status) {
+        complete(activity, status);
+    });
+    connect(activity, &QObject::destroyed, this, [this, activity] {
+        complete(activity, Activity::Status::Cancelled);
+    });
+
+    const auto key = activity->key();
+    if (!key.isEmpty()) {
+        auto leader = find(key);
+        if (leader) {
+            stats.deduped ++;
+            m_followers.insert(leader, activity);
+            // Don't leave a duplicate of an urgent activity behind.
+            for (auto& entry : m_queue) {
+                if (entry.activity == leader && entry.priority < priority) entry.priority = priority;
+            }
+            return;
+        }
+    }
+
+    Entry entry{ activity, activity->type(), priority, {}, m_clock.elapsed() };
+    for (auto dependency : dependencies) {
+        if (dependency) entry.dependencies.append(dependency);
+    }
+    m_queue.append(entry);
+    scheduleNext();
+}
+
+Activity* ActivityScheduler::find(const QString& key) const
+{
+    for (const auto& entry : m_running) {
+        if (entry.activity->key() == key) return entry.activity;
+    }
+    for (const auto& entry : m_queue) {
+        if (entry.activity->key() == key) return entry.activity;
+    }
+    return nullptr;
+}
+
+void ActivityScheduler::cancelAll()
+{
+    QList<Activity*> activities;
+    for (const auto& entry : m_running) activities.append(entry.activity);
+    for (const auto& entry : m_queue) activities.append(entry.activity);
+    for (const auto& follower : m_followers) {
+        if (follower) activities.append(follower);
+    }
+    // Followers of cancelled activities are promoted, cancel them first.
+    std::reverse(activities.begin(), activities.end());
+    for (auto activity : activities) activity->cancel();
+}
+
+void ActivityScheduler::complete(Activity* activity, Activity::Status status)
+{
+    if (status == Activity::Status::Pending) return;
+
+    // Drop a duplicate that completed on its own, usually cancelled.
+    for (auto i = m_followers.begin(); i != m_followers.end();) {
+        if (i.value().isNull() || i.value() == activity) {
+            i = m_followers.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    Entry entry;
+    bool found = false;
+    for (auto list : { &m_running, &m_queue }) {
+        for (int i = 0; i < list->size(); ++i) {
+            if (list->at(i).activity != activity) continue;
+            entry = list->takeAt(i);
+            found = true;
+            break;
+        }
+        if (found) break;
+    }
+    if (!found) return;
+
+    const qint64 now = m_clock.elapsed();
+    auto& stats = m_stats[entry.type];
+    if (entry.started_at >= 0) {
+        const qint64 run_time = now - entry.started_at;
+        stats.started ++;
+        stats.wait_time += entry.started_at - entry.scheduled_at;
+        stats.run_time += run_time;
+        stats.max_run_time = qMax(stats.max_run_time, run_time);
+    }
+    switch (status) {
+    case Activity::Status::Finished: stats.finished ++; break;
+    case Activity::Status::Failed: stats.failed ++; break;
+    default: stats.cancelled ++; break;
+    }
+
+    QList<Activity*> followers;
+    for (const auto& follower : m_followers.values(activity)) {
+        if (follower && follower->status() == Activity::Status::Pending) followers.append(follower);
+    }
+    m_followers.remove(activity);
+
+    if (status == Activity::Status::Finished) {
+        for (auto follower : followers) {
+            follower->adopt(activity);
+            follower->finish();
+        }
+    } else if (status == Activity::Status::Failed) {
+        for (auto follower : followers) follower->fail();
+    } else if (!followers.isEmpty()) {
+        // Still wanted by the duplicates, run the first of them instead.
+        auto leader = followers.takeFirst();
+        m_queue.append({ leader, entry.type, entry.priority, entry.dependencies, entry.scheduled_at });
+        for (auto follower : followers) m_followers.insert(leader, follower);
+    }
+
+    emit statsChanged();
+    scheduleNext();
+}
+
+bool ActivityScheduler::isReady(const Entry& entry) const
+{
+    for (const auto& dependency : entry.dependencies) {
+        if (dependency && dependency->status() == Activity::Status::Pending) return false;
+    }
+    return true;
+}
+
+void ActivityScheduler::scheduleNext()
+{
+    // Deferred so that activities never start from within the completion
+    // of another one.
+    if (m_next_scheduled) return;
+    m_next_scheduled = true;
+    QMetaObject::invokeMethod(this, &ActivityScheduler::next, Qt::QueuedConnection);
+}
+
+void ActivityScheduler::next()
+{
+    m_next_scheduled = false;
+    while (m_running.size() < m_max_running) {
+        // Highest priority first, in order of scheduling otherwise.
+        int index = -1;
+        for (int i = 0; i < m_queue.size(); ++i) {
+            if (!isReady(m_queue.at(i))) continue;
+            if (index < 0 || m_queue.at(i).priority > m_queue.at(index).priority) index = i;
+        }
+        if (index < 0) return;
+        auto entry = m_queue.takeAt(index);
+        entry.started_at = m_clock.elapsed();
+        m_running.append(entry);
+        entry.activity->exec();
+    }
+}
+
+QJsonObject ActivityScheduler::stats() const
+{
+    const qint64 uptime = qMax<qint64>(m_clock.elapsed(), 1);
+    QJsonObject result;
+    for (auto i = m_stats.begin(); i != m_stats.end(); ++i) {
+        const auto& stats = i.value();
+        const int started = qMax(stats.started, 1);
+        result.insert(i.key(), QJsonObject{
+            { "scheduled", stats.scheduled },
+            { "deduped", stats.deduped },
+            { "finished", stats.finished },
+            { "failed", stats.failed },
+            { "cancelled", stats.cancelled },
+            { "average_wait", stats.wait_time / started },
+            { "average_run", stats.run_time / started },
+            { "max_run", stats.max_run_time },
+            { "per_minute", stats.finished * 60000.0 / uptime }
+        });
+    }
+    return result;
+}
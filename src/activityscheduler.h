@@ -0,0 +1,80 @@
+#ifndef GREEN_ACTIVITYSCHEDULER_H
+#define GREEN_ACTIVITYSCHEDULER_H
+
+#include "activity.h"
+
+#include <QtQml>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+
+// Runs the activities of a wallet with a bounded number of them at once.
+// Queued activities start by priority once their dependencies completed.
+// Activities with the same key as a queued or running one don't run, they
+// complete with the results of the first one instead. Cancelled activities
+// are dropped from the queue, and if running their results are ignored.
+class ActivityScheduler : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QJsonObject stats READ stats NOTIFY statsChanged)
+    QML_ELEMENT
+    QML_UNCREATABLE("ActivityScheduler is owned by a wallet.")
+public:
+    enum class Priority {
+        Low,
+        Normal,
+        High,
+    };
+    Q_ENUM(Priority)
+    ActivityScheduler(int max_running, QObject* parent = nullptr);
+    virtual ~ActivityScheduler();
+    // Dependencies run before the activity regardless of their outcome.
+    void schedule(Activity* activity, Priority priority = Priority::Normal, const QList<Activity*>& dependencies = {});
+    // The queued or running activity with the given key, if any.
+    Activity* find(const QString& key) const;
+    void cancelAll();
+    // Counts, wait and run times in ms and throughput per minute, by
+    // activity type.
+    QJsonObject stats() const;
+signals:
+    void statsChanged();
+private:
+    struct Entry {
+        Activity* activity;
+        // Kept since the activity can be destroyed while scheduled.
+        QString type;
+        Priority priority;
+        QList<QPointer<Activity>> dependencies;
+        qint64 scheduled_at;
+        qint64 started_at{-1};
+    };
+    struct Stats {
+        int scheduled{0};
+        int deduped{0};
+        int started{0};
+        int finished{0};
+        int failed{0};
+        int cancelled{0};
+        qint64 wait_time{0};
+        qint64 run_time{0};
+        qint64 max_run_time{0};
+    };
+    void complete(Activity* activity, Activity::Status status);
+    void next();
+    void scheduleNext();
+    bool isReady(const Entry& entry) const;
+
+    const int m_max_running;
+    QElapsedTimer m_clock;
+    bool m_next_scheduled{false};
+    QList<Entry> m_queue;
+    QList<Entry> m_running;
+    // Duplicates waiting for the activity with the same key.
+    QMultiHash<Activity*, QPointer<Activity>> m_followers;
+    QHash<QString, Stats> m_stats;
+};
+
+#endif // GREEN_ACTIVITYSCHEDULER_H
@@ -12,7 +12,8 @@ AddressListModel::AddressListModel(QObject* parent)
     m_reload_timer->setInterval(200);
     connect(m_reload_timer, &QTimer::timeout, [this] {
         m_has_unconfirmed = false;
-        fetch(true);
+        m_last_pointer = 0;
+        fetch(true, false);
     });
 }
 
@@ -26,7 +27,10 @@ void AddressListModel::setAccount(Account* account)
     if (m_account) {
         beginResetModel();
         m_handler = nullptr;
+        m_prefetching = false;
+        m_last_pointer = 0;
         m_addresses.clear();
+        m_prefetched.clear();
         m_account = nullptr;
         emit accountChanged(nullptr);
         endResetModel();
@@ -39,13 +43,18 @@ void AddressListModel::setAccount(Account* account)
     }
 }
 
-void AddressListModel::fetch(bool reset)
+void AddressListModel::fetch(bool reset, bool background)
 {
     auto handler = new GetAddressesHandler(m_account->pointer(), m_last_pointer, m_account->wallet());
+    handler->setBackground(background);
 
     QObject::connect(handler, &Handler::done, this, [this, reset, handler] {
         handler->deleteLater();
+        // a reset or account change discarded this page
+        if (m_handler != handler) return;
+        const bool prefetched = m_prefetching;
         m_handler = nullptr;
+        m_prefetching = false;
         m_last_pointer = handler->lastPointer();
         emit fetchingChanged(false);
         // instantiate missing transactions
@@ -59,13 +68,14 @@ void AddressListModel::fetch(bool reset)
             // this happens after a bump fee for instance
             beginResetModel();
             m_addresses = addresses;
+            m_prefetched.clear();
             endResetModel();
+        } else if (prefetched) {
+            m_prefetched = addresses;
         } else {
-            // new page of transactions, just append to existing transaction
-            beginInsertRows(QModelIndex(), m_addresses.size(), m_addresses.size() + addresses.size() - 1);
-            m_addresses.append(addresses);
-            endInsertRows();
+            insert(addresses);
         }
+        prefetch();
     });
 
     connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
@@ -74,7 +84,24 @@ void AddressListModel::fetch(bool reset)
 
     handler->exec();
     m_handler = handler;
-    emit fetchingChanged(true);
+    m_prefetching = background;
+    if (!background) emit fetchingChanged(true);
+}
+
+void AddressListModel::prefetch()
+{
+    // Keep the next page read ahead of the exposed rows.
+    if (!m_account || m_handler || !m_prefetched.isEmpty() || m_last_pointer == 1) return;
+    fetch(false, true);
+}
+
+void AddressListModel::insert(const QVector<Address*>& addresses)
+{
+    if (addresses.isEmpty()) return;
+    // new page of addresses, just append to existing addresses
+    beginInsertRows(QModelIndex(), m_addresses.size(), m_addresses.size() + addresses.size() - 1);
+    m_addresses.append(addresses);
+    endInsertRows();
 }
 
 QHash<int, QByteArray> AddressListModel::roleNames() const
@@ -90,8 +117,9 @@ QHash<int, QByteArray> AddressListModel::roleNames() const
 bool AddressListModel::canFetchMore(const QModelIndex& parent) const
 {
     Q_ASSERT(!parent.parent().isValid());
-    // Prevent concurrent fetchMore
-    if (m_handler) return false;
+    if (!m_prefetched.isEmpty()) return true;
+    // Prevent concurrent fetchMore, a pending read ahead is taken over
+    if (fetching()) return false;
     return m_last_pointer != 1;
 }
 
@@ -99,8 +127,23 @@ void AddressListModel::fetchMore(const QModelIndex& parent)
 {
     Q_ASSERT(!parent.parent().isValid());
     if (!m_account) return;
-    if (m_handler) return;
-    fetch(false);
+    if (!m_prefetched.isEmpty()) {
+        const auto page = m_prefetched;
+        m_prefetched.clear();
+        insert(page);
+        prefetch();
+        return;
+    }
+    if (m_handler) {
+        // The view caught up with the read ahead, show its rows as soon as
+        // they arrive.
+        if (m_prefetching) {
+            m_prefetching = false;
+            emit fetchingChanged(true);
+        }
+        return;
+    }
+    fetch(false, false);
 }
 
 int AddressListModel::rowCount(const QModelIndex& parent) const
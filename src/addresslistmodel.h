@@ -27,7 +27,7 @@ public:
 
     Account* account() const { return m_account; }
     void setAccount(Account* account);
-    bool fetching() const { return m_handler != nullptr; }
+    bool fetching() const { return m_handler != nullptr && !m_prefetching; }
 
     QHash<int,QByteArray> roleNames() const override;
     void fetchMore(const QModelIndex& parent) override;
@@ -41,10 +41,15 @@ signals:
     void accountChanged(Account* account);
     void fetchingChanged(bool fetching);
 private:
-    void fetch(bool reset);
+    void fetch(bool reset, bool background);
+    void prefetch();
+    void insert(const QVector<Address*>& addresses);
 private:
     Account* m_account{nullptr};
     QVector<Address*> m_addresses;
+    // Read ahead page not yet exposed as rows, GDK decides the page size.
+    QVector<Address*> m_prefetched;
+    bool m_prefetching{false};
     bool m_has_unconfirmed{false};
     Handler* m_handler{nullptr};
     QTimer* const m_reload_timer;
@@ -12,6 +12,7 @@ Asset::Asset(const QString& id, Wallet* wallet)
     , m_wallet(wallet)
     , m_id(id)
 {
+    updateSortKey();
 }
 
 bool Asset::isLBTC() const
@@ -23,6 +24,7 @@ void Asset::setIcon(const QString &icon)
 {
     if (m_icon == icon) return;
     m_icon = icon;
+    updateSortKey();
     emit iconChanged();
 }
 
@@ -38,9 +40,16 @@ void Asset::setData(const QJsonObject &data)
 {
     if (m_data == data) return;
     m_data = data;
+    updateSortKey();
     emit dataChanged();
 }
 
+void Asset::updateSortKey()
+{
+    const int rank = isLBTC() ? 0 : hasIcon() ? 1 : hasData() ? 2 : 3;
+    m_sort_key = { rank, name() };
+}
+
 qint64 Asset::parseAmount(const QString& amount) const
 {
     if (isLBTC()) {
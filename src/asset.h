@@ -32,6 +32,9 @@ public:
     void setIcon(const QString& icon);
 
     QString name() const;
+    // Orders balances: the policy asset first, then assets with an icon,
+    // then assets with registry data, each group by name.
+    const QPair<int, QString>& sortKey() const { return m_sort_key; }
 
     bool hasData() const { return !m_data.isEmpty(); }
     QJsonObject data() const { return m_data; }
@@ -52,6 +55,8 @@ private:
     QString const m_id;
     QString m_icon;
     QJsonObject m_data;
+    QPair<int, QString> m_sort_key;
+    void updateSortKey();
 };
 
 #endif // GREEN_ASSET_H
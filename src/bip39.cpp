@@ -0,0 +1,70 @@
+#include "bip39.h"
+
+#include <QHash>
+#include <QMutex>
+
+#include <algorithm>
+
+#include <wally_bip39.h>
+
+const Bip39Wordlist* Bip39Wordlist::instance(const QString& language)
+{
+    static QMutex mutex;
+    static QHash<QString, Bip39Wordlist*> wordlists;
+    const QString key = language.isEmpty() ? QStringLiteral("en") : language;
+    QMutexLocker locker(&mutex);
+    auto wordlist = wordlists.value(key);
+    if (!wordlist) {
+        wordlist = new Bip39Wordlist(key);
+        wordlists.insert(key, wordlist);
+    }
+    return wordlist;
+}
+
+Bip39Wordlist::Bip39Wordlist(const QString& language)
+{
+    words* ws;
+    if (bip39_get_wordlist(language.toUtf8().constData(), &ws) != WALLY_OK) return;
+    m_words.reserve(BIP39_WORDLIST_LEN);
+    for (size_t i = 0; i < BIP39_WORDLIST_LEN; ++i) {
+        char* w;
+        if (bip39_get_word(ws, i, &w) != WALLY_OK) continue;
+        m_words.append(QString::fromUtf8(w));
+        wally_free_string(w);
+    }
+    // Only the english list is sorted upstream.
+    std::sort(m_words.begin(), m_words.end());
+}
+
+bool Bip39Wordlist::contains(const QString& word) const
+{
+    return std::binary_search(m_words.begin(), m_words.end(), word);
+}
+
+QPair<int, int> Bip39Wordlist::range(const QString& prefix) const
+{
+    auto first = m_words.begin();
+    auto last = m_words.end();
+    // Within the range of the first i characters, words are sorted by the
+    // character at i, missing characters sorting first.
+    for (int i = 0; i < prefix.length() && first != last; ++i) {
+        const QChar c = prefix.at(i);
+        first = std::lower_bound(first, last, c, [i](const QString& word, QChar c) {
+            return word.length() <= i || word.at(i) < c;
+        });
+        last = std::upper_bound(first, last, c, [i](QChar c, const QString& word) {
+            return word.length() > i && c < word.at(i);
+        });
+    }
+    return { static_cast<int>(first - m_words.begin()), static_cast<int>(last - m_words.begin()) };
+}
+
+QStringList Bip39Wordlist::words(QPair<int, int> range) const
+{
+    QStringList words;
+    words.reserve(range.second - range.first);
+    for (int i = range.first; i < range.second; ++i) {
+        words.append(m_words.at(i));
+    }
+    return words;
+}
@@ -0,0 +1,28 @@
+#ifndef GREEN_BIP39_H
+#define GREEN_BIP39_H
+
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Sorted index over a BIP39 wordlist, built on first use. Words sharing a
+// prefix are contiguous, so suggestions are a range found by narrowing one
+// character at a time, with no copies until the words are requested.
+class Bip39Wordlist
+{
+public:
+    // Language codes as in libwally, "en" by default.
+    static const Bip39Wordlist* instance(const QString& language = QString());
+
+    int size() const { return m_words.size(); }
+    bool contains(const QString& word) const;
+    // Half open range of the words starting with the prefix.
+    QPair<int, int> range(const QString& prefix) const;
+    QStringList words(QPair<int, int> range) const;
+private:
+    explicit Bip39Wordlist(const QString& language);
+    QVector<QString> m_words;
+};
+
+#endif // GREEN_BIP39_H
@@ -0,0 +1,291 @@
+#include "coinselector.h"
+
+#include <QMap>
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+namespace {
+    // Version, locktime, counts and segwit marker.
+    const int TX_OVERHEAD_VSIZE = 11;
+    const int OUTPUT_VSIZE = 34;
+    // Spending a change output later, for the cost of creating one.
+    const int CHANGE_SPEND_VSIZE = 68;
+    const qint64 DUST_THRESHOLD = 546;
+    const int BNB_MAX_TRIES = 100000;
+    const int BNB_MAX_COINS = 1000;
+    const int KNAPSACK_ITERATIONS = 1000;
+} // namespace
+
+QJsonObject CoinSelection::toJson() const
+{
+    return {
+        { "strategy", strategy },
+        { "valid", valid },
+        { "fee", fee },
+        { "change", change },
+        { "vsize", vsize },
+        { "inputs", inputs.size() }
+    };
+}
+
+CoinSelector::CoinSelector(const QJsonArray& utxos, qint64 fee_rate)
+    : m_fee_rate(fee_rate)
+{
+    for (const auto& value : utxos) {
+        const auto data = value.toObject();
+        // Skip locked and unconfirmed coins.
+        if (data.value("user_status").toInt() == 1) continue;
+        if (data.value("block_height").toDouble() == 0) continue;
+        Coin coin;
+        coin.data = data;
+        coin.value = data.value("satoshi").toDouble();
+        coin.address_type = data.value("address_type").toString();
+        coin.vsize = inputSize(coin.address_type);
+        coin.effective_value = coin.value - feeFor(coin.vsize);
+        // Not worth spending at this fee rate.
+        if (coin.effective_value <= 0) continue;
+        m_coins.append(coin);
+    }
+    std::sort(m_coins.begin(), m_coins.end(), [](const Coin& a, const Coin& b) {
+        return a.effective_value > b.effective_value;
+    });
+}
+
+int CoinSelector::inputSize(const QString& address_type)
+{
+    if (address_type == "p2pkh") return 148;
+    if (address_type == "p2sh-p2wpkh") return 91;
+    if (address_type == "p2wpkh") return 68;
+    // 2of2 multisig and csv inputs.
+    if (address_type == "p2sh") return 297;
+    if (address_type == "csv") return 96;
+    return 104;
+}
+
+qint64 CoinSelector::feeFor(qint64 vsize) const
+{
+    return (vsize * m_fee_rate + 999) / 1000;
+}
+
+qint64 CoinSelector::target(qint64 amount) const
+{
+    return amount + feeFor(TX_OVERHEAD_VSIZE + OUTPUT_VSIZE);
+}
+
+qint64 CoinSelector::costOfChange() const
+{
+    return feeFor(OUTPUT_VSIZE) + feeFor(CHANGE_SPEND_VSIZE);
+}
+
+CoinSelection CoinSelector::finalize(const QString& strategy, const QVector<const Coin*>& coins, qint64 amount) const
+{
+    CoinSelection selection;
+    selection.strategy = strategy;
+    if (coins.isEmpty()) return selection;
+
+    qint64 total = 0;
+    qint64 vsize = TX_OVERHEAD_VSIZE + OUTPUT_VSIZE;
+    for (auto coin : coins) {
+        total += coin->value;
+        vsize += coin->vsize;
+        selection.inputs.append(coin->data);
+    }
+
+    // With a change output if it isn't dust, otherwise the excess is fee.
+    const qint64 fee_with_change = feeFor(vsize + OUTPUT_VSIZE);
+    const qint64 change = total - amount - fee_with_change;
+    if (change >= DUST_THRESHOLD) {
+        selection.vsize = vsize + OUTPUT_VSIZE;
+        selection.fee = fee_with_change;
+        selection.change = change;
+    } else {
+        selection.vsize = vsize;
+        selection.fee = total - amount;
+        selection.change = 0;
+    }
+    selection.valid = selection.fee >= feeFor(vsize);
+    return selection;
+}
+
+CoinSelection CoinSelector::branchAndBound(qint64 amount) const
+{
+    const int count = std::min<int>(m_coins.size(), BNB_MAX_COINS);
+    const qint64 target = this->target(amount);
+    const qint64 upper = target + costOfChange();
+
+    // remaining[i] is the effective value available from coin i onwards.
+    QVector<qint64> remaining(count + 1, 0);
+    for (int i = count - 1; i >= 0; --i) {
+        remaining[i] = remaining[i + 1] + m_coins.at(i).effective_value;
+    }
+
+    QVector<bool> selected(count, false);
+    QVector<bool> best;
+    qint64 best_waste = upper - target + 1;
+    qint64 sum = 0;
+    int tries = 0;
+    int i = 0;
+    // Depth first search, include before exclude, backtracking on overshoot
+    // or when the remaining coins can't reach the target.
+    for (;;) {
+        bool backtrack = false;
+        if (++tries > BNB_MAX_TRIES) break;
+        if (sum > upper) {
+            backtrack = true;
+        } else if (sum >= target) {
+            if (sum - target < best_waste) {
+                best_waste = sum - target;
+                best = selected;
+                if (best_waste == 0) break;
+            }
+            backtrack = true;
+        } else if (i == count || sum + remaining[i] < target) {
+            backtrack = true;
+        }
+
+        if (backtrack) {
+            // Step back to the last included coin and exclude it.
+            while (i > 0 && !selected[i - 1]) --i;
+            if (i == 0) break;
+            --i;
+            selected[i] = false;
+            sum -= m_coins.at(i).effective_value;
+            ++i;
+        } else {
+            selected[i] = true;
+            sum += m_coins.at(i).effective_value;
+            ++i;
+        }
+    }
+
+    QVector<const Coin*> coins;
+    for (int j = 0; j < best.size(); ++j) {
+        if (best.at(j)) coins.append(&m_coins.at(j));
+    }
+    return finalize("bnb", coins, amount);
+}
+
+CoinSelection CoinSelector::knapsack(qint64 amount) const
+{
+    const qint64 target = this->target(amount) + costOfChange();
+    const int count = m_coins.size();
+
+    // Smallest single coin covering the target, if any.
+    const Coin* lowest_larger = nullptr;
+    for (const auto& coin : m_coins) {
+        if (coin.effective_value >= target) lowest_larger = &coin;
+    }
+
+    // Fixed seed so that previews are stable while typing.
+    QRandomGenerator random(count);
+    QVector<bool> best(count, true);
+    qint64 best_sum = 0;
+    for (const auto& coin : m_coins) best_sum += coin.effective_value;
+
+    QVector<bool> included(count);
+    for (int rep = 0; rep < KNAPSACK_ITERATIONS && best_sum != target; ++rep) {
+        included.fill(false);
+        qint64 total = 0;
+        bool reached = false;
+        for (int pass = 0; pass < 2 && !reached; ++pass) {
+            for (int i = 0; i < count; ++i) {
+                if (pass == 0 ? random.bounded(2) == 0 : included.at(i)) continue;
+                total += m_coins.at(i).effective_value;
+                included[i] = true;
+                if (total >= target) {
+                    reached = true;
+                    if (total < best_sum) {
+                        best_sum = total;
+                        best = included;
+                    }
+                    total -= m_coins.at(i).effective_value;
+                    included[i] = false;
+                }
+            }
+        }
+    }
+
+    QVector<const Coin*> coins;
+    if (lowest_larger && (best_sum < target || lowest_larger->effective_value <= best_sum)) {
+        coins.append(lowest_larger);
+    } else {
+        for (int i = 0; i < count; ++i) {
+            if (best.at(i)) coins.append(&m_coins.at(i));
+        }
+    }
+    return finalize("knapsack", coins, amount);
+}
+
+CoinSelection CoinSelector::largestFirst(const QString& strategy, const QVector<const Coin*>& coins, qint64 amount) const
+{
+    const qint64 target = this->target(amount) + feeFor(OUTPUT_VSIZE);
+    QVector<const Coin*> selected;
+    qint64 sum = 0;
+    for (auto coin : coins) {
+        if (sum >= target) break;
+        selected.append(coin);
+        sum += coin->effective_value;
+    }
+    if (sum < target) return finalize(strategy, {}, amount);
+    return finalize(strategy, selected, amount);
+}
+
+CoinSelection CoinSelector::largestFirst(qint64 amount) const
+{
+    QVector<const Coin*> coins;
+    for (const auto& coin : m_coins) coins.append(&coin);
+    return largestFirst("largest_first", coins, amount);
+}
+
+CoinSelection CoinSelector::privacy(qint64 amount) const
+{
+    const qint64 target = this->target(amount) + feeFor(OUTPUT_VSIZE);
+
+    // A single coin doesn't link any addresses, pick the smallest one.
+    for (int i = m_coins.size() - 1; i >= 0; --i) {
+        if (m_coins.at(i).effective_value >= target) {
+            return finalize("privacy", { &m_coins.at(i) }, amount);
+        }
+    }
+
+    // Otherwise don't mix address types, use the group needing fewer inputs.
+    QMap<QString, QVector<const Coin*>> groups;
+    for (const auto& coin : m_coins) groups[coin.address_type].append(&coin);
+    CoinSelection best;
+    best.strategy = "privacy";
+    for (const auto& group : groups) {
+        auto selection = largestFirst("privacy", group, amount);
+        if (!selection.valid) continue;
+        if (!best.valid || selection.inputs.size() < best.inputs.size()) best = selection;
+    }
+    return best;
+}
+
+CoinSelection CoinSelector::evaluate(const QJsonArray& inputs, qint64 amount) const
+{
+    QVector<Coin> coins;
+    for (const auto& value : inputs) {
+        const auto data = value.toObject();
+        Coin coin;
+        coin.data = data;
+        coin.value = data.value("satoshi").toDouble();
+        coin.address_type = data.value("address_type").toString();
+        coin.vsize = inputSize(coin.address_type);
+        coin.effective_value = coin.value - feeFor(coin.vsize);
+        coins.append(coin);
+    }
+    QVector<const Coin*> pointers;
+    for (const auto& coin : coins) pointers.append(&coin);
+    return finalize("manual", pointers, amount);
+}
+
+QVector<CoinSelection> CoinSelector::selectAll(qint64 amount) const
+{
+    return {
+        branchAndBound(amount),
+        knapsack(amount),
+        largestFirst(amount),
+        privacy(amount)
+    };
+}
@@ -0,0 +1,60 @@
+#ifndef GREEN_COINSELECTOR_H
+#define GREEN_COINSELECTOR_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+struct CoinSelection
+{
+    QString strategy;
+    QJsonArray inputs;
+    qint64 fee{0};
+    qint64 change{0};
+    qint64 vsize{0};
+    bool valid{false};
+    QJsonObject toJson() const;
+};
+
+// Selects coins locally among the unspent outputs of an account, so that
+// the fee, change and input count of several strategies can be previewed
+// without a GDK round trip. Values are in satoshi, the fee rate in satoshi
+// per 1000 virtual bytes like in GDK.
+class CoinSelector
+{
+public:
+    CoinSelector(const QJsonArray& utxos, qint64 fee_rate);
+
+    // Exact match without change output, minimizing the excess.
+    CoinSelection branchAndBound(qint64 amount) const;
+    // Randomized subset sum closest to the amount plus change.
+    CoinSelection knapsack(qint64 amount) const;
+    CoinSelection largestFirst(qint64 amount) const;
+    // Avoids linking address types, prefers a single coin.
+    CoinSelection privacy(qint64 amount) const;
+    // Evaluates the given inputs, used for manual coin selection.
+    CoinSelection evaluate(const QJsonArray& inputs, qint64 amount) const;
+    QVector<CoinSelection> selectAll(qint64 amount) const;
+
+private:
+    struct Coin {
+        QJsonObject data;
+        qint64 value;
+        qint64 effective_value;
+        int vsize;
+        QString address_type;
+    };
+    qint64 feeFor(qint64 vsize) const;
+    qint64 target(qint64 amount) const;
+    qint64 costOfChange() const;
+    CoinSelection finalize(const QString& strategy, const QVector<const Coin*>& coins, qint64 amount) const;
+    CoinSelection largestFirst(const QString& strategy, const QVector<const Coin*>& coins, qint64 amount) const;
+    static int inputSize(const QString& address_type);
+
+    const qint64 m_fee_rate;
+    // Spendable coins sorted by descending effective value.
+    QVector<Coin> m_coins;
+};
+
+#endif // GREEN_COINSELECTOR_H
@@ -1,71 +1,94 @@
 #ifndef GREEN_COMMAND_H
 #define GREEN_COMMAND_H
 
+#include <QByteArray>
 #include <QObject>
+#include <QPointer>
+#include <QVector>
 
-QT_FORWARD_DECLARE_CLASS(Device)
+#include <functional>
 
-class CommandBatch;
+QT_FORWARD_DECLARE_CLASS(Device)
+QT_FORWARD_DECLARE_CLASS(QDataStream)
 
-class Command : public QObject
+// Device commands are plain objects owned by the device queue. Completion is
+// reported through the handlers given to then(), which are only invoked while
+// the context object is alive. Once completed the command is released.
+class DeviceCommand
 {
-    Q_OBJECT
 public:
-    Command(CommandBatch* batch = nullptr);
-    virtual ~Command();
-public slots:
-    virtual void exec() = 0;
-signals:
-    void error();
-    void finished();
-};
+    typedef std::function<void(const QByteArray&)> FinishedHandler;
+    typedef std::function<void()> ErrorHandler;
 
-class DeviceCommand : public Command
-{
-public:
-    DeviceCommand(Device* device, CommandBatch* batch = nullptr)
-        : Command(batch)
-        , m_device(device)
+    DeviceCommand(Device* device)
+        : m_device(device)
     {
     }
+    virtual ~DeviceCommand() {}
+    void then(QObject* context, const FinishedHandler& finished, const ErrorHandler& error);
+    virtual void exec() = 0;
     virtual QByteArray payload() const = 0;
+    // Payload to write to the device, marks the start of the exchange.
+    QByteArray transmit();
     virtual bool parse(const QByteArray& data);
     virtual bool parse(QDataStream& stream) { Q_UNUSED(stream); Q_UNIMPLEMENTED(); Q_UNREACHABLE(); };
+    // Called after each successful response, commands that exchange more
+    // than one APDU queue themselves again and return true.
+    virtual bool next() { return false; }
     int readHIDReport(Device* device, QDataStream& stream);
     bool readAPDUResponse(Device* device, int length, QDataStream& stream);
+    void fail();
 
     Device* const m_device;
     uint16_t length;
     uint16_t offset;
     QByteArray buf;
     QByteArray m_response;
+protected:
+    QObject* context() const { return m_context; }
+    void complete(bool success);
+    // Pooled commands override this to return to their pool.
+    virtual void release() { delete this; }
+private:
+    qint64 m_sent_at{-1};
+    QString m_trace_name;
+    QPointer<QObject> m_context;
+    FinishedHandler m_finished_handler;
+    ErrorHandler m_error_handler;
 };
 
-class CommandBatch : public Command
+// Recycles released commands so that exchanging an APDU doesn't allocate.
+template <typename T>
+class CommandPool
 {
-    Q_OBJECT
 public:
-    void add(Command* command) { m_commands.append(command); }
-    void exec() override {
-        if (m_commands.isEmpty()) return emit finished();
-        auto next = m_commands.takeFirst();
-        connect(next, &Command::finished, this, &Command::exec, Qt::QueuedConnection);
-        connect(next, &Command::error, this, &Command::error);
-        next->exec();
+    ~CommandPool() { qDeleteAll(m_commands); }
+    template <typename... Args>
+    T* acquire(Args&&... args)
+    {
+        if (m_commands.isEmpty()) {
+            m_allocations++;
+            return new T(std::forward<Args>(args)...);
+        }
+        return m_commands.takeLast();
     }
+    void release(T* command) { m_commands.append(command); }
+    int allocations() const { return m_allocations; }
 private:
-    QList<Command*> m_commands;
+    QVector<T*> m_commands;
+    int m_allocations{0};
 };
 
 class GenericCommand : public DeviceCommand
 {
-    const QByteArray m_data;
 public:
-    GenericCommand(Device* device, const QByteArray& data, CommandBatch* batch = nullptr)
-        : DeviceCommand(device, batch)
-        , m_data(data) {}
+    GenericCommand(Device* device)
+        : DeviceCommand(device) {}
+    void setData(const QByteArray& data) { m_data = data; }
     QByteArray payload() const override { return m_data; }
     virtual bool parse(QDataStream&) override { return true; };
+private:
+    QByteArray m_data;
 };
 
 #endif // GREEN_COMMAND_H
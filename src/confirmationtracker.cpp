@@ -0,0 +1,84 @@
+#include "account.h"
+#include "confirmationtracker.h"
+#include "network.h"
+#include "output.h"
+#include "transaction.h"
+#include "wallet.h"
+
+ConfirmationTracker::ConfirmationTracker(Account* account)
+    : QObject(account)
+    , m_account(account)
+    , m_settle_confirmations(account->wallet()->network()->isLiquid() ? 1 : 6)
+{
+}
+
+void ConfirmationTracker::track(Transaction* transaction)
+{
+    auto i = m_settle_height.find(transaction);
+    if (i != m_settle_height.end()) {
+        m_transactions_by_settle_height.remove(i.value(), transaction);
+        m_settle_height.erase(i);
+    }
+
+    // Unconfirmed transactions only change when refetched.
+    const quint32 block_height = transaction->blockHeight();
+    if (block_height == 0) return;
+
+    // Confirmations are 1 + height - block_height, past the settle height
+    // the displayed status no longer changes.
+    const quint32 settle_height = block_height + m_settle_confirmations - 1;
+    if (settle_height <= m_account->wallet()->blockHeight()) return;
+
+    m_transactions_by_settle_height.insert(settle_height, transaction);
+    m_settle_height.insert(transaction, settle_height);
+}
+
+void ConfirmationTracker::track(Output* output)
+{
+    auto i = m_expiry_height.find(output);
+    if (i != m_expiry_height.end()) {
+        m_outputs_by_expiry_height.remove(i.value(), output);
+        m_expiry_height.erase(i);
+    }
+
+    if (output->addressType() != "csv" || output->unconfirmed() || output->expired()) return;
+
+    const auto data = output->data();
+    const quint32 expiry_height = data.value("block_height").toDouble() + data.value("subtype").toDouble();
+    m_outputs_by_expiry_height.insert(expiry_height, output);
+    m_expiry_height.insert(output, expiry_height);
+}
+
+void ConfirmationTracker::update(quint32 height)
+{
+    if (height <= m_height) {
+        m_height = height;
+        return;
+    }
+    m_height = height;
+
+    QVector<Transaction*> transactions;
+    for (auto i = m_transactions_by_settle_height.begin(); i != m_transactions_by_settle_height.end();) {
+        auto transaction = i.value();
+        transactions.append(transaction);
+        emit transaction->confirmationsChanged();
+        if (i.key() <= height) {
+            m_settle_height.remove(transaction);
+            i = m_transactions_by_settle_height.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    QVector<Output*> outputs;
+    for (auto i = m_outputs_by_expiry_height.begin(); i != m_outputs_by_expiry_height.end() && i.key() < height;) {
+        auto output = i.value();
+        outputs.append(output);
+        m_expiry_height.remove(output);
+        i = m_outputs_by_expiry_height.erase(i);
+        output->update();
+    }
+
+    if (!transactions.isEmpty()) emit transactionsChanged(transactions);
+    if (!outputs.isEmpty()) emit outputsChanged(outputs);
+}
@@ -0,0 +1,37 @@
+#ifndef GREEN_CONFIRMATIONTRACKER_H
+#define GREEN_CONFIRMATIONTRACKER_H
+
+#include <QHash>
+#include <QMultiMap>
+#include <QObject>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(Account)
+QT_FORWARD_DECLARE_CLASS(Output)
+QT_FORWARD_DECLARE_CLASS(Transaction)
+
+// Indexes the account transactions by the height at which their confirmation
+// count stops being relevant, and the CSV outputs by their expiry height, so
+// that a new block only touches the items whose state changes with it.
+class ConfirmationTracker : public QObject
+{
+    Q_OBJECT
+public:
+    ConfirmationTracker(Account* account);
+    void track(Transaction* transaction);
+    void track(Output* output);
+    void update(quint32 height);
+signals:
+    void transactionsChanged(const QVector<Transaction*>& transactions);
+    void outputsChanged(const QVector<Output*>& outputs);
+private:
+    Account* const m_account;
+    const int m_settle_confirmations;
+    quint32 m_height{0};
+    QMultiMap<quint32, Transaction*> m_transactions_by_settle_height;
+    QHash<Transaction*, quint32> m_settle_height;
+    QMultiMap<quint32, Output*> m_outputs_by_expiry_height;
+    QHash<Output*, quint32> m_expiry_height;
+};
+
+#endif // GREEN_CONFIRMATIONTRACKER_H
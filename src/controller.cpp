@@ -298,10 +298,10 @@ void Controller::requestTwoFactorReset(const QString& email)
     if (!m_wallet) return;
     auto handler = new TwoFactorResetHandler(email.toLatin1(), m_wallet);
     connect(handler, &Handler::done, this, [this, handler] {
-        m_wallet->updateConfig();
-        // TODO: updateConfig doesn't update 2f reset data,
+        // TODO: two factor config doesn't update 2f reset data,
         // it's only updated after authentication in GDK,
-        // so force wallet lock for now.
+        // so force wallet lock for now. Not refreshing config since
+        // its stale reset data would undo this once it arrives.
         m_wallet->setLocked(true);
         handler->deleteLater();
         emit finished();
@@ -314,10 +314,10 @@ void Controller::cancelTwoFactorReset()
     if (!m_wallet) return;
     auto handler = new TwoFactorCancelResetHandler(m_wallet);
     connect(handler, &Handler::done, this, [this, handler] {
-        m_wallet->updateConfig();
-        // TODO: updateConfig doesn't update 2f reset data,
+        // TODO: two factor config doesn't update 2f reset data,
         // it's only updated after authentication in GDK,
-        // so force wallet unlock for now.
+        // so force wallet unlock for now. Not refreshing config since
+        // its stale reset data would undo this once it arrives.
         m_wallet->setLocked(false);
         handler->deleteLater();
         emit finished();
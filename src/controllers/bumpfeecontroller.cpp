@@ -2,6 +2,7 @@
 #include "account.h"
 #include "asset.h"
 #include "balance.h"
+#include "feeestimator.h"
 #include "handlers/createtransactionhandler.h"
 #include "handlers/sendtransactionhandler.h"
 #include "handlers/signtransactionhandler.h"
@@ -65,6 +66,12 @@ void BumpFeeController::create()
     auto t = transaction();
     auto a = account();
 
+    if (!m_fee_rate) {
+        // Default to the shared estimate for the block target in settings.
+        const int blocks = wallet()->settings().value("required_num_blocks").toInt();
+        m_fee_rate = static_cast<int>(FeeEstimator::instance(wallet()->network())->feeRate(blocks));
+    }
+
     QJsonObject details{
         { "subaccount", static_cast<qint64>(a->pointer()) },
         { "fee_rate", m_fee_rate },
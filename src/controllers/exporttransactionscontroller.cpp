@@ -70,7 +70,7 @@ void ExportTransactionsController::nextPage()
             auto transaction = m_account->getOrCreateTransaction(data);
             const auto block_height = data.value("block_height").toInt();
             if (block_height == 0) continue;
-            for (auto amount : transaction->m_amounts) {
+            for (auto amount : transaction->amountList()) {
                 const auto asset = amount->asset();
                 QStringList values;
                 for (auto field : m_fields) {
@@ -129,7 +129,7 @@ void LedgerDeviceController::initialize()
             setStatus("error");
             //QTimer::singleShot(1000, this, &LedgerDeviceController::initialize);
         });
-        activity->exec();
+        device->schedule(activity, this);
         return;
     }
 #endif
@@ -150,7 +150,7 @@ void LedgerDeviceController::initialize()
             setStatus("error");
             //QTimer::singleShot(1000, this, &LedgerDeviceController::initialize);
         });
-        activity->exec();
+        device->schedule(activity, this);
         return;
     }
 #endif
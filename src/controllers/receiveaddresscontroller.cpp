@@ -1,34 +1,9 @@
 #include "receiveaddresscontroller.h"
 #include "account.h"
-#include "handler.h"
-#include "json.h"
 #include "network.h"
-#include "resolver.h"
-#include "session.h"
+#include "receiveaddresspool.h"
 #include "wallet.h"
 
-#include <gdk.h>
-
-class GetReceiveAddressHandler : public Handler
-{
-    Account* const m_account;
-    void call(GA_session* session, GA_auth_handler** auth_handler) override
-    {
-        auto address_details = Json::fromObject({
-            { "subaccount", static_cast<qint64>(m_account->pointer()) },
-        });
-
-        int err = GA_get_receive_address(session, address_details.get(), auth_handler);
-        Q_ASSERT(err == GA_OK);
-    }
-public:
-    GetReceiveAddressHandler(Account* account)
-        : Handler(account->wallet())
-        , m_account(account)
-    {
-    }
-};
-
 ReceiveAddressController::ReceiveAddressController(QObject *parent) : QObject(parent)
 {
 
@@ -47,6 +22,8 @@ void ReceiveAddressController::setAccount(Account *account)
 {
     if (m_account == account) return;
 
+    disconnectPool();
+    setGenerating(false);
     m_account = account;
     emit accountChanged(m_account);
 
@@ -114,20 +91,37 @@ void ReceiveAddressController::generate()
 
     if (m_generating) return;
 
-    setGenerating(true);
-
-    auto handler = new GetReceiveAddressHandler(m_account);
-    connect(handler, &Handler::done, this, [this, handler] {
-        m_result = handler->result().value("result").toObject();
+    auto pool = m_account->receiveAddressPool();
+    if (!pool->isEmpty()) {
+        m_result = pool->take();
         m_address = m_result.value("address").toString();
-        setGenerating(false);
         setAddressVerification(VerificationNone);
         emit changed();
-    });
-    connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
-        resolver->resolve();
-    });
-    handler->exec();
+        return;
+    }
+
+    // Wait for the pool, generating now if it wasn't already.
+    setGenerating(true);
+    m_pool_connections = {
+        connect(pool, &ReceiveAddressPool::available, this, [this] {
+            disconnectPool();
+            setGenerating(false);
+            generate();
+        }),
+        connect(pool, &ReceiveAddressPool::failed, this, [this] {
+            disconnectPool();
+            setGenerating(false);
+        })
+    };
+    pool->refill(true);
+}
+
+void ReceiveAddressController::disconnectPool()
+{
+    for (const auto& connection : m_pool_connections) {
+        disconnect(connection);
+    }
+    m_pool_connections.clear();
 }
 
 #include "jadedevice.h"
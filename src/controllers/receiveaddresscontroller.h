@@ -48,6 +48,8 @@ signals:
     void changed();
     void generatingChanged(bool generating);
     void addressVerificationChanged(AddressVerification address_verification);
+private:
+    void disconnectPool();
 public:
     Account* m_account{nullptr};
     QString m_amount;
@@ -55,6 +57,7 @@ public:
     QJsonObject m_result;
     bool m_generating{false};
     AddressVerification m_address_verification{VerificationNone};
+    QList<QMetaObject::Connection> m_pool_connections;
 };
 
 #endif // GREEN_RECEIVEADDRESSCONTROLLER_H
@@ -1,19 +1,76 @@
 #include "account.h"
+#include "activityscheduler.h"
 #include "asset.h"
 #include "balance.h"
+#include "coinselector.h"
+#include "feeestimator.h"
 #include "handlers/createtransactionhandler.h"
 #include "handlers/sendtransactionhandler.h"
 #include "handlers/signtransactionhandler.h"
 #include "json.h"
 #include "network.h"
+#include "output.h"
 #include "sendcontroller.h"
+#include "tracer.h"
 #include "wallet.h"
 
+#include <QtMath>
+
+namespace {
+
+// Satoshi per unit of the denominations in wallet settings.
+qint64 UnitFactor(const QString& unit)
+{
+    const auto u = unit.toLower();
+    if (u == "btc") return 100000000;
+    if (u == "mbtc") return 100000;
+    if (u == "\u00B5btc" || u == "ubtc" || u == "bits") return 100;
+    return 1;
+}
+
+int UnitDecimals(qint64 factor)
+{
+    return qRound(std::log10(static_cast<double>(factor)));
+}
+
+double ParseNumber(QString value, bool* ok)
+{
+    value.replace(',', '.');
+    return QLocale::c().toDouble(value, ok);
+}
+
+// Errors that outdated cached coins can cause, as opposed to invalid input
+// like an incomplete address.
+bool IsCoinError(const QString& error)
+{
+    return error == "id_insufficient_funds" || error.contains("utxo", Qt::CaseInsensitive);
+}
+
+} // namespace
+
 SendController::SendController(QObject* parent)
     : AccountController(parent)
+    , m_create_timer(new QTimer(this))
 {
-    connect(this, &SendController::accountChanged, this, &SendController::create);
-    connect(this, &SendController::walletChanged, this, &SendController::create);
+    // Transaction creation waits for the inputs to settle, meanwhile the
+    // local estimate is shown.
+    m_create_timer->setSingleShot(true);
+    m_create_timer->setInterval(300);
+    connect(m_create_timer, &QTimer::timeout, this, &SendController::build);
+    connect(this, &SendController::accountChanged, this, [this] {
+        disconnect(m_account_connection);
+        m_coins = {};
+        m_selection = {};
+        if (m_account) m_account_connection = connect(m_account, &Account::transactionEvent, this, &SendController::fetchCoins);
+        fetchCoins();
+        create();
+    });
+    connect(this, &SendController::walletChanged, this, [this] {
+        if (wallet()) connect(wallet(), &Wallet::settingsChanged, this, &SendController::updateFiatRate, Qt::UniqueConnection);
+        updateFiatRate();
+        if (wallet()) FeeEstimator::instance(wallet()->network())->update();
+        create();
+    });
 }
 
 bool SendController::isValid() const
@@ -125,41 +182,71 @@ QJsonObject SendController::transaction() const
     return m_transaction;
 }
 
+void SendController::updateFiatRate()
+{
+    m_fiat_rate = -1;
+    if (!wallet() || !wallet()->session() || !wallet()->isAuthenticated()) return;
+    // Only query GDK when pricing changes, keystrokes convert locally.
+    const auto res = wallet()->convert({{ "satoshi", 100000000 }});
+    bool ok;
+    const double rate = ParseNumber(res.value("fiat").toString(), &ok);
+    if (ok) m_fiat_rate = rate;
+}
+
+void SendController::fetchCoins()
+{
+    // Account changed meanwhile, the coins are no longer needed.
+    if (m_get_coins_activity && m_get_coins_activity->account() != account()) {
+        m_get_coins_activity->cancel();
+        m_get_coins_activity->deleteLater();
+        m_get_coins_activity.update(nullptr);
+    }
+    if (!wallet() || !account()) return;
+    // Liquid coin selection is left to GDK, it depends on blinding.
+    if (wallet()->network()->isLiquid() || wallet()->network()->isElectrum()) return;
+    if (m_get_coins_activity) return;
+
+    auto activity = new AccountGetUnspentOutputsActivity(account(), 1, false, this);
+    m_get_coins_activity.update(activity);
+    m_get_coins_activity.track(connect(activity, &Activity::finished, this, [this, activity] {
+        activity->deleteLater();
+        m_get_coins_activity.update(nullptr);
+        QJsonArray coins;
+        for (auto output : activity->outputs()) {
+            coins.append(output->data());
+        }
+        m_coins = coins;
+        updateEstimate();
+    }));
+    wallet()->scheduler()->schedule(activity);
+}
+
 void SendController::update()
 {
     if (!wallet()) return;
     const bool is_liquid = wallet()->network()->isLiquid();
     if (hasFiatRate()) {
         if (!m_send_all) {
-            auto unit = wallet()->settings().value("unit").toString();
-            unit = unit == "\u00B5BTC" ? "ubtc" : unit.toLower();
-            QJsonObject convert;
-
-            if (m_send_all) {
-    //            if (is_liquid) {
-    //                if (m_balance) {
-    //                    convert.insert("sats", QString::number(m_balance->amount()));
-    //                }
-    //            } else {
-    //                auto satoshi = account()->json().value("satoshi").toObject();
-    //                Q_ASSERT(satoshi.contains("btc"));
-    //                convert.insert("sats", QString::number(satoshi.value("btc").toDouble()));
-    //            }
-            } else if (!m_amount.isEmpty()) {
+            const auto factor = UnitFactor(wallet()->settings().value("unit").toString());
+            bool ok = false;
+            qint64 satoshi = 0;
+            if (!m_amount.isEmpty()) {
                 Q_ASSERT(m_fiat_amount.isEmpty());
-                auto amount = m_amount;
-                amount.replace(',', '.');
-                convert.insert(unit, amount);
+                satoshi = qRound64(ParseNumber(m_amount, &ok) * factor);
             } else if (!m_fiat_amount.isEmpty()) {
                 Q_ASSERT(m_amount.isEmpty());
-                auto fiat = m_fiat_amount;
-                fiat.replace(',', '.');
-                convert.insert("fiat", fiat);
+                const double fiat = ParseNumber(m_fiat_amount, &ok);
+                ok = ok && m_fiat_rate > 0;
+                if (ok) satoshi = qRound64(fiat / m_fiat_rate * 100000000);
             }
 
-            const auto res = wallet()->convert(convert);
-            m_effective_amount = res.value(unit).toString();
-            m_effective_fiat_amount = res.value("fiat").isNull() ? "n/a" : res.value("fiat").toString();
+            if (ok) {
+                m_effective_amount = QString::number(static_cast<double>(satoshi) / factor, 'f', UnitDecimals(factor));
+                m_effective_fiat_amount = m_fiat_rate < 0 ? "n/a" : QString::number(satoshi * m_fiat_rate / 100000000, 'f', 2);
+            } else {
+                m_effective_amount.clear();
+                m_effective_fiat_amount = m_fiat_rate < 0 ? "n/a" : QString();
+            }
         }
     } else {
         Q_ASSERT(is_liquid);
@@ -180,12 +267,11 @@ void SendController::create()
 {
     if (!wallet() || !account()) return;
 
-    const quint64 count = ++m_count;
-    if (m_create_handler) return;
+    // Traces the latency of each edit until the transaction is created.
+    m_input_begin = Tracer::instance()->now();
 
-    if (!wallet()->network()->isLiquid()) {
-        Q_ASSERT(!m_balance);
-    }
+    // Any result in flight is now stale.
+    ++m_count;
 
     setValid(false);
 
@@ -194,13 +280,114 @@ void SendController::create()
     // Also clears m_transaction so that no error is shown.
     if ((m_amount.isEmpty() && m_address.isEmpty()) ||
         (wallet()->network()->isLiquid() && !m_balance)) {
+        m_create_timer->stop();
         m_transaction = {};
         emit transactionChanged();
+        updateEstimate();
         return;
     }
 
+    {
+        TraceSpan span("send", "estimate", wallet());
+        updateEstimate();
+    }
+    m_create_timer->start();
+}
+
+void SendController::updateEstimate()
+{
+    const bool is_liquid = wallet()->network()->isLiquid();
+    const bool pays_fee = !is_liquid || (m_balance && m_balance->asset()->isLBTC());
+
+    // Virtual size of the last created transaction is the best guess for
+    // the next one, otherwise assume one input and two outputs.
+    qint64 vsize = m_vsize > 0 ? m_vsize : (is_liquid ? 1300 : 141);
+    const qint64 fee_rate = m_fee_rate > 1000 ? m_fee_rate : 1000;
+    qint64 fee = fee_rate * vsize / 1000;
+
+    qint64 available = 0;
+    qint64 satoshi = 0;
+    if (is_liquid) {
+        if (m_balance) {
+            available = m_balance->amount();
+            if (!m_effective_amount.isEmpty() && !m_balance->asset()->isLBTC()) {
+                satoshi = m_balance->asset()->parseAmount(m_effective_amount);
+            }
+        }
+    } else {
+        available = account()->balance();
+    }
+    if (m_send_all) {
+        satoshi = qMax<qint64>(0, available - (pays_fee ? fee : 0));
+    } else if (satoshi == 0 && !m_effective_amount.isEmpty() && pays_fee) {
+        const auto factor = UnitFactor(wallet()->settings().value("unit").toString());
+        bool ok;
+        const double value = ParseNumber(m_effective_amount, &ok);
+        if (ok) satoshi = qRound64(value * factor);
+    }
+
+    // Upper bound, refined below by local coin selection when possible.
+    qint64 change = available - satoshi - (pays_fee ? fee : 0);
+    bool insufficient = change < 0;
+
+    // Preview each strategy over the cached coins, the first valid among
+    // branch and bound, knapsack and largest first is passed to GDK.
+    QJsonArray strategies;
+    m_selection = {};
+    if (!is_liquid && !m_send_all && satoshi > 0 && (m_manual_coin_selection || !m_coins.isEmpty())) {
+        const CoinSelector selector(m_coins, fee_rate);
+        QVector<CoinSelection> selections;
+        if (m_manual_coin_selection) {
+            selections.append(selector.evaluate(m_utxos.value("btc").toArray(), satoshi));
+        } else {
+            selections = selector.selectAll(satoshi);
+        }
+        const CoinSelection* selection = nullptr;
+        for (const auto& s : selections) {
+            strategies.append(s.toJson());
+            if (!selection && s.valid && s.strategy != "privacy") selection = &s;
+        }
+        if (selection) {
+            fee = selection->fee;
+            vsize = selection->vsize;
+            change = selection->change;
+            insufficient = false;
+            if (!m_manual_coin_selection) m_selection = selection->inputs;
+        } else {
+            insufficient = true;
+        }
+    }
+
+    QJsonObject estimate{
+        { "satoshi", satoshi },
+        { "fee", fee },
+        { "vsize", vsize },
+        { "change", qMax<qint64>(0, change) },
+        { "insufficient", insufficient },
+        { "strategies", strategies }
+    };
+    if (m_estimate == estimate) return;
+    m_estimate = estimate;
+    emit estimateChanged();
+}
+
+void SendController::build()
+{
+    if (!wallet() || !account()) return;
+    // The current result will be discarded and creation retried once it
+    // finishes, GDK calls can't be interrupted.
+    if (m_create_handler) return;
+
+    const quint64 count = m_count;
+
+    if (!wallet()->network()->isLiquid()) {
+        Q_ASSERT(!m_balance);
+    }
+
     if (!m_fee_rate) {
-        m_fee_rate = static_cast<qint64>(wallet()->settings().value("required_num_blocks").toInt());
+        // Default to the shared estimate for the block target in settings.
+        const int blocks = wallet()->settings().value("required_num_blocks").toInt();
+        m_fee_rate = FeeEstimator::instance(wallet()->network())->feeRate(blocks);
     }
 
     QJsonObject address{{ "address", m_address }};
@@ -235,12 +422,28 @@ void SendController::create()
             data.insert("used_utxos", used_utxos);
             data.insert("utxo_strategy", "manual");
         }
+    } else if (!m_selection.isEmpty() && !m_send_all) {
+        // Coins were selected locally, GDK only builds the transaction.
+        data.insert("utxos", QJsonObject{{ "btc", m_selection }});
+        data.insert("used_utxos", m_selection);
+        data.insert("utxo_strategy", "manual");
     }
+    const bool local_selection = data.value("utxo_strategy") == "manual" && !m_manual_coin_selection;
 
     m_create_handler = new CreateTransactionHandler(wallet(), data);
-    connect(m_create_handler, &Handler::done, this, [this, count] {
+    connect(m_create_handler, &Handler::done, this, [this, count, local_selection] {
+        m_create_handler->deleteLater();
         if (m_count == count) {
             m_transaction = m_create_handler->result().value("result").toObject();
+            m_create_handler = nullptr;
+            // Cached coins can be outdated, let GDK select them instead.
+            if (local_selection && IsCoinError(m_transaction.value("error").toString())) {
+                m_selection = {};
+                fetchCoins();
+                return build();
+            }
+            const qint64 vsize = m_transaction.value("transaction_vsize").toDouble();
+            if (vsize > 0) m_vsize = vsize;
 
             if (m_send_all) {
                 const auto satoshi = m_transaction.value("transaction_outputs").toArray().first().toObject().value("satoshi").toDouble();
@@ -252,12 +455,18 @@ void SendController::create()
             emit transactionChanged();
             setValid(true);
             m_count = 0;
-            m_create_handler = nullptr;
+            Tracer::instance()->span("send", "create transaction", m_input_begin, wallet());
         } else {
             m_create_handler = nullptr;
-            create();
+            // Inputs changed meanwhile, retry unless they are still changing.
+            if (!m_create_timer->isActive()) build();
         }
     });
+    connect(m_create_handler, &Handler::error, this, [this, count] {
+        m_create_handler->deleteLater();
+        m_create_handler = nullptr;
+        if (m_count != count && !m_create_timer->isActive()) build();
+    });
     exec(m_create_handler);
 }
 
@@ -1,7 +1,11 @@
 #ifndef GREEN_SENDCONTROLLER_H
 #define GREEN_SENDCONTROLLER_H
 
+#include "account.h"
 #include "accountcontroller.h"
+#include "connectable.h"
+
+#include <QJsonArray>
 
 QT_FORWARD_DECLARE_CLASS(Balance)
 QT_FORWARD_DECLARE_CLASS(Transaction)
@@ -23,6 +27,7 @@ class SendController : public AccountController
     Q_PROPERTY(QJsonObject utxos READ utxos WRITE setUtxos NOTIFY utxosChanged)
     Q_PROPERTY(bool hasFiatRate READ hasFiatRate NOTIFY changed)
     Q_PROPERTY(QJsonObject transaction READ transaction NOTIFY transactionChanged)
+    Q_PROPERTY(QJsonObject estimate READ estimate NOTIFY estimateChanged)
     Q_PROPERTY(Transaction* signedTransaction READ signedTransaction NOTIFY signedTransactionChanged)
     QML_ELEMENT
 public:
@@ -58,6 +63,7 @@ public:
     bool hasFiatRate() const;
 
     QJsonObject transaction() const;
+    QJsonObject estimate() const { return m_estimate; }
 
     Transaction* signedTransaction() const { return m_signed_transaction; }
 
@@ -73,6 +79,7 @@ public slots:
 signals:
     void changed();
     void transactionChanged();
+    void estimateChanged();
     void signedTransactionChanged(Transaction* transaction);
 
     void utxosChanged(QJsonObject utxos);
@@ -80,6 +87,10 @@ signals:
 private:
     void update();
     void create();
+    void build();
+    void updateEstimate();
+    void updateFiatRate();
+    void fetchCoins();
     void setSignedTransaction(Transaction* signed_transaction);
 
     QJsonObject m_utxos;
@@ -97,8 +108,20 @@ protected:
     QString m_memo;
     qint64 m_fee_rate{0};
     QJsonObject m_transaction;
+    QJsonObject m_estimate;
+    // Fiat per BTC, negative when there's no rate.
+    double m_fiat_rate{-1};
+    qint64 m_vsize{0};
+    // Spendable coins of the account for local coin selection, and the
+    // selection passed to GDK when creating the transaction.
+    Connectable<AccountGetUnspentOutputsActivity> m_get_coins_activity;
+    QMetaObject::Connection m_account_connection;
+    QJsonArray m_coins;
+    QJsonArray m_selection;
     void setValid(bool valid);
     Handler* m_create_handler{nullptr};
+    QTimer* const m_create_timer;
+    qint64 m_input_begin{0};
     Transaction* m_signed_transaction{nullptr};
 };
 
@@ -1,4 +1,5 @@
 #include "activity.h"
+#include "tracer.h"
 
 Progress::Progress(QObject* parent)
     : QObject(parent)
@@ -40,6 +41,7 @@ void Progress::incrementValue(int inc)
 
 Activity::Activity(QObject* parent)
     : QObject(parent)
+    , m_trace_begin(Tracer::instance()->now())
 {
 }
 
@@ -55,8 +57,10 @@ Activity::Status Activity::status() const
 
 void Activity::finish()
 {
+    if (m_status == Status::Cancelled) return;
     Q_ASSERT(m_status == Status::Pending);
     m_status = Status::Finished;
+    Tracer::instance()->span("activity", type(), m_trace_begin);
     emit statusChanged(m_status);
     emit finished();
     m_progress.setValue(m_progress.to());
@@ -65,13 +69,25 @@ void Activity::finish()
 
 void Activity::fail()
 {
+    if (m_status == Status::Cancelled) return;
     Q_ASSERT(m_status == Status::Pending);
     m_status = Status::Failed;
+    Tracer::instance()->span("activity", type() + " failed", m_trace_begin);
     emit statusChanged(m_status);
     emit failed();
     m_progress.setIndeterminate(false);
 }
 
+void Activity::cancel()
+{
+    if (m_status != Status::Pending) return;
+    m_status = Status::Cancelled;
+    Tracer::instance()->span("activity", type() + " cancelled", m_trace_begin);
+    emit statusChanged(m_status);
+    emit cancelled();
+    m_progress.setIndeterminate(false);
+}
+
 void Activity::setMessage(const QJsonObject& message)
 {
     if (m_message == message) return;
@@ -49,6 +49,7 @@ public:
         Pending,
         Finished,
         Failed,
+        Cancelled,
     };
     Q_ENUM(Status)
     Activity(QObject* parent = nullptr);
@@ -59,6 +60,13 @@ public:
     void setMessage(const QJsonObject& message);
     void finish();
     void fail();
+    // Results of a cancelled activity are ignored, finish() and fail() are
+    // no-ops afterwards.
+    void cancel();
+    // Activities with the same non empty key are identical, the scheduler
+    // runs only one of them and the others adopt its results.
+    virtual QString key() const { return {}; }
+    virtual void adopt(Activity* other) { Q_UNUSED(other); }
     // TODO exec should not exists since not all activities have an action
     // TODO instead each activity subclass should have a concrete "action" method, like "sign"
     virtual void exec() = 0;
@@ -66,11 +74,13 @@ signals:
     void statusChanged(Status status);
     void finished();
     void failed();
+    void cancelled();
     void messageChanged(const QJsonObject& message);
 private:
     Status m_status{Status::Pending};
     Progress m_progress;
     QJsonObject m_message;
+    const qint64 m_trace_begin;
 };
 
 #endif // GREEN_ACTIVITY_H
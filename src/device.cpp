@@ -6,6 +6,7 @@
 #include "json.h"
 #include "network.h"
 #include "networkmanager.h"
+#include "tracer.h"
 #include "util.h"
 #include "wallet.h"
 #include "walletmanager.h"
@@ -45,8 +46,79 @@ Device::Type Device::typefromVendorAndProduct(uint32_t vendor_id, uint32_t produ
     return Device::NoType;
 }
 
+void Device::schedule(Activity* activity, QObject* owner)
+{
+    Q_ASSERT(owner);
+    if (!m_pending.contains(owner)) {
+        m_owners.append(owner);
+        connect(owner, &QObject::destroyed, this, [this, owner] { drop(owner); });
+    }
+    m_pending[owner].enqueue(activity);
+    emit queueDepthChanged(++m_queue_depth);
+    next();
+}
+
+qint64 Device::busyTime() const
+{
+    return m_active ? m_busy_time + m_busy_timer.elapsed() : m_busy_time;
+}
+
+void Device::next()
+{
+    if (m_active || m_owners.isEmpty()) return;
+
+    auto owner = m_owners.takeFirst();
+    auto& pending = m_pending[owner];
+    m_active = pending.dequeue();
+    if (pending.isEmpty()) {
+        disconnect(owner, &QObject::destroyed, this, nullptr);
+        m_pending.remove(owner);
+    } else {
+        m_owners.append(owner);
+    }
+    emit queueDepthChanged(--m_queue_depth);
+
+    auto done = [this, activity = m_active] {
+        if (m_active != activity) return;
+        m_busy_time += m_busy_timer.elapsed();
+        m_active = nullptr;
+        emit busyTimeChanged(m_busy_time);
+        next();
+    };
+    connect(m_active, &Activity::finished, this, done);
+    connect(m_active, &Activity::failed, this, done);
+    connect(m_active, &Activity::cancelled, this, done);
+    connect(m_active, &QObject::destroyed, this, done);
+    m_busy_timer.start();
+    m_active->exec();
+}
+
+void Device::drop(QObject* owner)
+{
+    m_owners.removeOne(owner);
+    const auto pending = m_pending.take(owner);
+    m_queue_depth -= pending.size();
+    emit queueDepthChanged(m_queue_depth);
+    qDeleteAll(pending);
+}
+
+QByteArray DeviceCommand::transmit()
+{
+    const auto data = payload();
+    m_sent_at = Tracer::instance()->now();
+    // Named by the instruction byte of the APDU.
+    m_trace_name = QString("apdu %1").arg(data.size() > 1 ? QString::number(quint8(data.at(1)), 16) : QString());
+    Tracer::instance()->count("hid bytes sent", data.size());
+    return data;
+}
+
 bool DeviceCommand::readAPDUResponse(Device*, int length, QDataStream &stream)
 {
+    if (m_sent_at >= 0) {
+        Tracer::instance()->span("apdu", m_trace_name, m_sent_at);
+        m_sent_at = -1;
+    }
+    Tracer::instance()->count("hid bytes received", length);
     QByteArray response;
     if (length > 0) {
         response.resize(length - 2);
@@ -55,26 +127,52 @@ bool DeviceCommand::readAPDUResponse(Device*, int length, QDataStream &stream)
     uint16_t sw;
     stream >> sw;
     if (sw != 0x9000) {
-        emit error();
+        complete(false);
         return false;
     }
     bool result = parse(response);
     if (result) {
         m_response = response;
-        emit finished();
+        if (!next()) complete(true);
+    } else {
+        complete(false);
     }
     return result;
 }
 
-Command::Command(CommandBatch* batch)
-    : QObject(batch)
+void DeviceCommand::then(QObject* context, const FinishedHandler& finished, const ErrorHandler& error)
 {
-    if (batch) batch->add(this);
+    Q_ASSERT(context);
+    m_context = context;
+    m_finished_handler = finished;
+    m_error_handler = error;
 }
 
-Command::~Command()
+void DeviceCommand::fail()
 {
+    complete(false);
+}
 
+void DeviceCommand::complete(bool success)
+{
+    // the command is released before invoking the handlers so that they can
+    // reuse it for the next exchange
+    const QPointer<QObject> context = m_context;
+    const auto finished_handler = std::move(m_finished_handler);
+    const auto error_handler = std::move(m_error_handler);
+    const auto response = m_response;
+    m_context.clear();
+    m_finished_handler = nullptr;
+    m_error_handler = nullptr;
+    m_response.clear();
+    release();
+
+    if (!context) return;
+    if (success) {
+        if (finished_handler) finished_handler(response);
+    } else {
+        if (error_handler) error_handler();
+    }
 }
 
 bool DeviceCommand::parse(const QByteArray& data)
@@ -112,6 +210,8 @@ int DeviceCommand::readHIDReport(Device* device, QDataStream& stream)
 
     if (length > 0) return 2;
 
-    QDataStream s(buf);
-    return readAPDUResponse(device, buf.size(), s) ? 0 : 1;
+    const QByteArray response = buf;
+    buf.clear();
+    QDataStream s(response);
+    return readAPDUResponse(device, response.size(), s) ? 0 : 1;
 }
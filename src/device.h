@@ -2,7 +2,9 @@
 #define GREEN_DEVICE_H
 
 #include <QtQml>
+#include <QElapsedTimer>
 #include <QObject>
+#include <QQueue>
 
 #include "activity.h"
 
@@ -70,6 +72,8 @@ class Device : public QObject
     Q_PROPERTY(Transport transport READ transport CONSTANT)
     Q_PROPERTY(Type type READ type CONSTANT)
     Q_PROPERTY(QString name READ name NOTIFY nameChanged)
+    Q_PROPERTY(int queueDepth READ queueDepth NOTIFY queueDepthChanged)
+    Q_PROPERTY(qint64 busyTime READ busyTime NOTIFY busyTimeChanged)
     QML_ELEMENT
     QML_UNCREATABLE("Devices are instanced by DeviceDiscoveryAgent.")
 public:
@@ -105,10 +109,27 @@ public:
     virtual SignLiquidTransactionActivity* signLiquidTransaction(const QJsonObject& transaction, const QJsonArray& signing_inputs, const QJsonArray& outputs) = 0;
 
     static Type typefromVendorAndProduct(uint32_t vendor_id, uint32_t product_id);
+
+    // Activities are executed one at a time since most of them exchange
+    // several messages that can't be interleaved. Owners are served in
+    // turns so that one wallet can't starve the others.
+    void schedule(Activity* activity, QObject* owner);
+    int queueDepth() const { return m_queue_depth; }
+    qint64 busyTime() const;
 signals:
     void nameChanged();
+    void queueDepthChanged(int queue_depth);
+    void busyTimeChanged(qint64 busy_time);
 private:
+    void next();
+    void drop(QObject* owner);
     const QString m_uuid;
+    QList<QObject*> m_owners;
+    QHash<QObject*, QQueue<Activity*>> m_pending;
+    Activity* m_active{nullptr};
+    int m_queue_depth{0};
+    QElapsedTimer m_busy_timer;
+    qint64 m_busy_time{0};
 };
 
 QT_FORWARD_DECLARE_CLASS(LedgerDevice);
@@ -14,6 +14,8 @@
 #include <linux/hid.h>
 #include <linux/types.h>
 #include <linux/hidraw.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
 DeviceDiscoveryAgentPrivate::DeviceDiscoveryAgentPrivate(DeviceDiscoveryAgent *q)
@@ -145,14 +147,8 @@ void DeviceDiscoveryAgentPrivate::addDevice(udev_device* handle)
     m_devices.insert(devpath, impl);
     DeviceManager::instance()->addDevice(device);
 
-    auto notifier = new QSocketNotifier(fd, QSocketNotifier::Read);
-    notifier->setEnabled(true);
-    QObject::connect(notifier, &QSocketNotifier::activated, [impl, fd, notifier] {
-        char b[64];
-        auto x = read(fd, (void*) b, 64);
-        if (x == 64) impl->inputReport(QByteArray::fromRawData(b, 64));
-        else notifier->deleteLater();
-    });
+    impl->m_thread = new DeviceIOThread(impl, fd);
+    impl->m_thread->start(QThread::HighPriority);
     // udev_device_unref(handle);
 }
 
@@ -186,50 +182,173 @@ QList<QByteArray> transport(const QByteArray& data) {
     return packets;
 }
 
+DevicePrivateImpl::~DevicePrivateImpl()
+{
+    if (m_thread) {
+        m_thread->stop();
+        m_thread->wait();
+        delete m_thread;
+    }
+    close(fd);
+}
+
 void DevicePrivateImpl::exchange(DeviceCommand* command)
 {
     const bool send = queue.empty();
-    if (send) {
-        const auto payload = command->payload();
-        for (const auto& packet : transport(payload)) {
-            QByteArray report;
-            report.append(uint8_t(0));
-            report.append(packet);
-            int res = write(fd, report.constData(), report.size());
-            Q_ASSERT(res == report.size());
-        }
-    }
     queue.enqueue(command);
+    if (send) m_thread->write(command->transmit());
 }
 
-void DevicePrivateImpl::inputReport(const QByteArray& data)
+void DevicePrivateImpl::apduResponse(const QByteArray& response)
 {
     if (queue.empty()) {
-        qDebug() << "READ UNKNOWN REPORT" << data.toHex();
+        qDebug() << "READ UNKNOWN RESPONSE" << response.toHex();
         return;
     }
-    Q_ASSERT(!queue.empty());
-    QDataStream stream(data);
+    QDataStream stream(response);
     auto command = queue.head();
-    int r = command->readHIDReport(q, stream);
-    if (r == 2) return;
-    if (r == 1) qWarning("command failed");
+    if (!command->readAPDUResponse(q, response.size(), stream)) qWarning("command failed");
     queue.dequeue();
-    if (!queue.empty()) {
-        command = queue.head();
-        const auto payload = command->payload();
-        for (const auto& packet : transport(payload)) {
-            QByteArray report;
-            report.append(uint8_t(0));
-            report.append(packet);
-            int res = write(fd, report.constData(), report.size());
-            if (res < 0) {
-                qDebug() << "FAILED";
-                delete command;
-                return;
+    if (!queue.empty()) m_thread->write(queue.head()->transmit());
+}
+
+#define CHANNEL_DEFAULT_ID 0x0101
+#define TAG_APDU 0x05
+#define HID_REPORT_SIZE 64
+
+DeviceIOThread::DeviceIOThread(DevicePrivateImpl* impl, int fd)
+    : QThread()
+    , m_impl(impl)
+    , m_fd(fd)
+{
+    m_event_fd = eventfd(0, EFD_CLOEXEC);
+    Q_ASSERT(m_event_fd >= 0);
+}
+
+DeviceIOThread::~DeviceIOThread()
+{
+    close(m_event_fd);
+}
+
+void DeviceIOThread::write(const QByteArray& payload)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_outgoing.enqueue(payload);
+    }
+    const uint64_t value = 1;
+    ::write(m_event_fd, &value, sizeof(value));
+}
+
+void DeviceIOThread::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stop = true;
+    }
+    const uint64_t value = 1;
+    ::write(m_event_fd, &value, sizeof(value));
+}
+
+void DeviceIOThread::run()
+{
+    const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    Q_ASSERT(epoll_fd >= 0);
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = m_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_fd, &event);
+    event.data.fd = m_event_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_event_fd, &event);
+
+    bool running = true;
+    while (running) {
+        struct epoll_event events[2];
+        const int count = epoll_wait(epoll_fd, events, 2, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < count && running; ++i) {
+            if (events[i].data.fd == m_event_fd) {
+                uint64_t value;
+                ::read(m_event_fd, &value, sizeof(value));
+                QQueue<QByteArray> outgoing;
+                {
+                    QMutexLocker locker(&m_mutex);
+                    if (m_stop) running = false;
+                    outgoing.swap(m_outgoing);
+                }
+                while (running && !outgoing.empty()) {
+                    running = writePackets(outgoing.dequeue());
+                }
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                // device was unplugged, removal is handled by the udev monitor
+                running = false;
+            } else {
+                char report[HID_REPORT_SIZE];
+                const auto size = ::read(m_fd, report, HID_REPORT_SIZE);
+                if (size == HID_REPORT_SIZE) {
+                    readReport(QByteArray::fromRawData(report, HID_REPORT_SIZE));
+                } else if (size < 0 && errno != EINTR && errno != EAGAIN) {
+                    running = false;
+                }
             }
         }
     }
+
+    close(epoll_fd);
+}
+
+bool DeviceIOThread::writePackets(const QByteArray& payload)
+{
+    for (const auto& packet : transport(payload)) {
+        QByteArray report;
+        report.append(uint8_t(0));
+        report.append(packet);
+        const auto res = ::write(m_fd, report.constData(), report.size());
+        if (res != report.size()) {
+            qDebug() << "FAILED";
+            return false;
+        }
+    }
+    return true;
+}
+
+void DeviceIOThread::readReport(const QByteArray& report)
+{
+    const auto data = reinterpret_cast<const uint8_t*>(report.constData());
+    const uint16_t channel_id = (data[0] << 8) | data[1];
+    const uint8_t command_tag = data[2];
+    const uint16_t index = (data[3] << 8) | data[4];
+
+    if (channel_id != CHANNEL_DEFAULT_ID || command_tag != TAG_APDU) {
+        qDebug() << "READ UNKNOWN REPORT" << report.toHex();
+        return;
+    }
+
+    int offset = 5;
+    if (index == 0) {
+        m_remaining = (data[5] << 8) | data[6];
+        m_response.clear();
+        m_response.reserve(m_remaining);
+        m_next_index = 0;
+        offset = 7;
+    } else if (index != m_next_index) {
+        qDebug() << "READ OUT OF ORDER REPORT" << index << m_next_index;
+        return;
+    }
+    m_next_index++;
+
+    const int length = qMin(m_remaining, HID_REPORT_SIZE - offset);
+    m_response.append(report.constData() + offset, length);
+    m_remaining -= length;
+    if (m_remaining > 0) return;
+
+    QMetaObject::invokeMethod(m_impl->q, [impl = m_impl, response = m_response] {
+        impl->apduResponse(response);
+    }, Qt::QueuedConnection);
 }
 
 #endif // Q_OS_LINUX
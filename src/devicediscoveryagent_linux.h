@@ -6,18 +6,51 @@
 #ifdef Q_OS_LINUX
 #include "device_p.h"
 
+#include <QMutex>
+#include <QQueue>
 #include <QSocketNotifier>
+#include <QThread>
 #include <libudev.h>
 
 class DeviceDiscoveryAgent;
+class DevicePrivateImpl;
+
+// Services the hidraw fd of a single device. Reports are read and APDU
+// responses are reassembled in this thread, only complete responses are
+// posted to the thread of the owning device.
+class DeviceIOThread : public QThread
+{
+public:
+    DeviceIOThread(DevicePrivateImpl* impl, int fd);
+    ~DeviceIOThread();
+    void write(const QByteArray& payload);
+    void stop();
+protected:
+    void run() override;
+private:
+    bool writePackets(const QByteArray& payload);
+    void readReport(const QByteArray& report);
+
+    DevicePrivateImpl* const m_impl;
+    const int m_fd;
+    int m_event_fd{-1};
+    QMutex m_mutex;
+    QQueue<QByteArray> m_outgoing;
+    bool m_stop{false};
+    QByteArray m_response;
+    int m_remaining{0};
+    uint16_t m_next_index{0};
+};
 
 class DevicePrivateImpl : public DevicePrivate
 {
 public:
+    ~DevicePrivateImpl();
     udev_device* handle;
     int fd;
+    DeviceIOThread* m_thread{nullptr};
     void exchange(DeviceCommand* command) override;
-    void inputReport(const QByteArray& data);
+    void apduResponse(const QByteArray& response);
 };
 
 class DeviceDiscoveryAgentPrivate
@@ -186,13 +186,13 @@ void DevicePrivateImpl::exchange(DeviceCommand* command)
 {
     const bool send = queue.empty();
     if (send) {
-        const auto payload = command->payload();
+        const auto payload = command->transmit();
         //qDebug() << "send " << payload.toHex();
         for (const auto& packet : transport(payload)) {
             //qDebug() << "send packet " << packet.toHex();
             auto res = IOHIDDeviceSetReport(handle, kIOHIDReportTypeOutput, 0, (const uint8_t*) packet.constData(), packet.size());
             if (res != kIOReturnSuccess) {
-                emit command->error();
+                command->fail();
                 return;
             }
         }
@@ -209,23 +209,19 @@ void DevicePrivateImpl::inputReport(const QByteArray& data)
     auto command = queue.head();
     int r = command->readHIDReport(q, stream);
     if (r == 2) return;
-    if (r == 1) {
-        qWarning("command failed");
-        qDebug() << command << command->objectName();
-        delete command;
-    }
+    if (r == 1) qWarning("command failed");
     queue.dequeue();
     if (!queue.empty()) {
         //qDebug() << "sending next command";
         command = queue.head();
-        const auto payload = command->payload();
+        const auto payload = command->transmit();
         //qDebug() << "send " << payload.toHex();
         for (const auto& packet : transport(payload)) {
             //qDebug() << "send packet " << packet.toHex();
             auto res = IOHIDDeviceSetReport(handle, kIOHIDReportTypeOutput, 0, (const uint8_t*) packet.constData(), packet.size());
             if (res != kIOReturnSuccess) {
-                emit command->error();
-                delete command;
+                queue.dequeue();
+                command->fail();
                 return;
             }
         }
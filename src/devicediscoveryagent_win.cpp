@@ -143,7 +143,7 @@ void DevicePrivateImpl::exchange(DeviceCommand *command)
 {
     const bool send = queue.empty();
     if (send) {
-        const auto payload = command->payload();
+        const auto payload = command->transmit();
         for (const auto& packet : transport(payload)) {
             QByteArray report;
             report.append(uint8_t(0));
@@ -171,7 +171,7 @@ void DevicePrivateImpl::inputReport(const QByteArray& data)
     if (!queue.empty()) {
         //qDebug() << "sending next command";
         command = queue.head();
-        const auto payload = command->payload();
+        const auto payload = command->transmit();
         //qDebug() << "send " << payload.toHex();
         for (const auto& packet : transport(payload)) {
             qDebug() << "send packet " << packet.toHex();
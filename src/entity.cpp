@@ -14,8 +14,12 @@ QQmlListProperty<Activity> Entity::activities()
 void Entity::pushActivity(Activity* activity)
 {
     connect(activity, &Activity::destroyed, this, [this, activity] {
-        m_activities.removeOne(activity);
-        emit activitiesChanged();
+        if (m_activities.removeOne(activity)) emit activitiesChanged();
+    });
+    // Cancelled activities may be kept alive by their owner, they are no
+    // longer running though.
+    connect(activity, &Activity::cancelled, this, [this, activity] {
+        if (m_activities.removeOne(activity)) emit activitiesChanged();
     });
     m_activities.append(activity);
     emit activitiesChanged();
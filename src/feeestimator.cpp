@@ -0,0 +1,132 @@
+#include "feeestimator.h"
+#include "handlers/getfeeestimateshandler.h"
+#include "network.h"
+#include "session.h"
+#include "wallet.h"
+
+#include <QDebug>
+#include <QMap>
+#include <QTimer>
+
+namespace {
+    const int REFRESH_INTERVAL = 120000;
+    // Estimates younger than this are served without a request.
+    const int MAX_AGE = 60000;
+    // A day of refreshes.
+    const int MAX_HISTORY = 720;
+    // Default minimum relay fee rates in satoshi per 1000 virtual bytes.
+    const qint64 MIN_FEE_RATE = 1000;
+    const qint64 LIQUID_MIN_FEE_RATE = 100;
+} // namespace
+
+FeeEstimator* FeeEstimator::instance(Network* network)
+{
+    Q_ASSERT(network);
+    static QMap<Network*, FeeEstimator*> estimators;
+    auto estimator = estimators.value(network);
+    if (!estimator) {
+        estimator = new FeeEstimator(network);
+        estimators.insert(network, estimator);
+    }
+    return estimator;
+}
+
+FeeEstimator::FeeEstimator(Network* network)
+    : QObject(network)
+    , m_network(network)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setInterval(REFRESH_INTERVAL);
+    connect(m_timer, &QTimer::timeout, this, &FeeEstimator::refresh);
+}
+
+FeeEstimator::~FeeEstimator()
+{
+}
+
+qint64 FeeEstimator::feeRate(int blocks) const
+{
+    if (blocks < 0 || blocks >= m_fees.size()) return minFeeRate();
+    return qMax(static_cast<qint64>(m_fees.at(blocks).toDouble()), minFeeRate());
+}
+
+qint64 FeeEstimator::minFeeRate() const
+{
+    if (!m_fees.isEmpty()) return static_cast<qint64>(m_fees.at(0).toDouble());
+    return m_network->isLiquid() ? LIQUID_MIN_FEE_RATE : MIN_FEE_RATE;
+}
+
+QJsonArray FeeEstimator::historyJson() const
+{
+    QJsonArray history;
+    for (const auto& sample : m_history) {
+        history.append(QJsonObject{
+            { "timestamp", sample.timestamp.toMSecsSinceEpoch() },
+            { "fees", sample.fees }
+        });
+    }
+    return history;
+}
+
+void FeeEstimator::addWallet(Wallet* wallet)
+{
+    Q_ASSERT(wallet && wallet->network() == m_network);
+    if (!m_wallets.contains(wallet)) {
+        connect(wallet, &QObject::destroyed, this, [this, wallet] {
+            m_wallets.removeAll(wallet);
+            if (m_wallets.isEmpty()) m_timer->stop();
+        });
+    }
+    m_wallets.append(wallet);
+    if (!m_timer->isActive()) m_timer->start();
+    update();
+}
+
+void FeeEstimator::removeWallet(Wallet* wallet)
+{
+    m_wallets.removeOne(wallet);
+    if (m_wallets.isEmpty()) m_timer->stop();
+}
+
+void FeeEstimator::update()
+{
+    if (m_last_update.isValid() && m_last_update.elapsed() < MAX_AGE) return;
+    refresh();
+}
+
+void FeeEstimator::refresh()
+{
+    if (m_handler) return;
+
+    Wallet* wallet = nullptr;
+    for (auto candidate : m_wallets) {
+        auto session = candidate->session();
+        if (session && session->isConnected() && candidate->isAuthenticated()) {
+            wallet = candidate;
+            break;
+        }
+    }
+    if (!wallet) return;
+
+    auto handler = new GetFeeEstimatesHandler(wallet);
+    m_handler.update(handler);
+    m_handler.track(connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
+        m_handler.update(nullptr);
+        const auto fees = handler->fees();
+        if (fees.isEmpty()) return;
+        m_last_update.start();
+        m_history.append({ QDateTime::currentDateTimeUtc(), fees });
+        if (m_history.size() > MAX_HISTORY) m_history.removeFirst();
+        emit historyChanged();
+        if (m_fees == fees) return;
+        m_fees = fees;
+        emit feesChanged(m_fees);
+    }));
+    m_handler.track(connect(handler, &Handler::error, this, [this, handler] {
+        handler->deleteLater();
+        m_handler.update(nullptr);
+        qDebug() << "fee estimates failed for" << m_network->id();
+    }));
+    handler->exec();
+}
@@ -0,0 +1,62 @@
+#ifndef GREEN_FEEESTIMATOR_H
+#define GREEN_FEEESTIMATOR_H
+
+#include "connectable.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QObject>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(GetFeeEstimatesHandler)
+QT_FORWARD_DECLARE_CLASS(Network)
+QT_FORWARD_DECLARE_CLASS(QTimer)
+QT_FORWARD_DECLARE_CLASS(Wallet)
+
+// Fee estimates are the same for all wallets on a network, so one estimator
+// per network refreshes them asynchronously through any authenticated wallet
+// while some wallet uses them. Each refresh is kept with its timestamp so
+// that trends can be shown without further requests.
+class FeeEstimator : public QObject
+{
+    Q_OBJECT
+public:
+    struct Sample {
+        QDateTime timestamp;
+        QJsonArray fees;
+    };
+    static FeeEstimator* instance(Network* network);
+    virtual ~FeeEstimator();
+
+    QJsonArray fees() const { return m_fees; }
+    // Fee rate in satoshi per 1000 virtual bytes for the given block target,
+    // the minimum relay fee rate if not known yet.
+    qint64 feeRate(int blocks) const;
+    // Minimum relay fee rate, the first estimate or the network default
+    // before the first refresh.
+    qint64 minFeeRate() const;
+    QVector<Sample> history() const { return m_history; }
+    QJsonArray historyJson() const;
+
+    // Wallets using the estimates, refreshes run while there is any.
+    void addWallet(Wallet* wallet);
+    void removeWallet(Wallet* wallet);
+    // Refreshes unless the estimates are recent or a refresh is running.
+    void update();
+signals:
+    void feesChanged(const QJsonArray& fees);
+    void historyChanged();
+private:
+    explicit FeeEstimator(Network* network);
+    void refresh();
+    Network* const m_network;
+    QTimer* const m_timer;
+    QList<Wallet*> m_wallets;
+    Connectable<GetFeeEstimatesHandler> m_handler;
+    QElapsedTimer m_last_update;
+    QJsonArray m_fees;
+    QVector<Sample> m_history;
+};
+
+#endif // GREEN_FEEESTIMATOR_H
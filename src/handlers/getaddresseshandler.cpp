@@ -19,6 +19,7 @@ GetAddressesHandler::GetAddressesHandler(int subaccount, int last_pointer, Walle
     , m_subaccount(subaccount)
     , m_last_pointer(last_pointer)
 {
+    setTraceAccount(subaccount);
 }
 
 QJsonArray GetAddressesHandler::addresses() const
@@ -8,6 +8,7 @@ GetBalanceHandler::GetBalanceHandler(Account* account)
     : Handler(account->wallet())
     , m_account(account)
 {
+    setTraceAccount(account->pointer());
 }
 
 void GetBalanceHandler::call(GA_session* session, GA_auth_handler** auth_handler)
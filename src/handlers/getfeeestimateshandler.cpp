@@ -0,0 +1,19 @@
+#include "getfeeestimateshandler.h"
+#include "json.h"
+
+#include <gdk.h>
+
+GetFeeEstimatesHandler::GetFeeEstimatesHandler(Wallet* wallet)
+    : Handler(wallet)
+{
+}
+
+void GetFeeEstimatesHandler::call(GA_session* session, GA_auth_handler** auth_handler)
+{
+    Q_UNUSED(auth_handler);
+    GA_json* estimates;
+    if (GA_OK == GA_get_fee_estimates(session, &estimates)) {
+        m_fees = Json::toObject(estimates).value("fees").toArray();
+        GA_destroy_json(estimates);
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef GREEN_GETFEEESTIMATESHANDLER_H
+#define GREEN_GETFEEESTIMATESHANDLER_H
+
+#include "handler.h"
+
+#include <QJsonArray>
+
+class GetFeeEstimatesHandler : public Handler
+{
+    QJsonArray m_fees;
+    void call(GA_session* session, GA_auth_handler** auth_handler) override;
+public:
+    GetFeeEstimatesHandler(Wallet* wallet);
+    // Fee rates in satoshi per 1000 virtual bytes indexed by block target.
+    QJsonArray fees() const { return m_fees; }
+};
+
+#endif // GREEN_GETFEEESTIMATESHANDLER_H
@@ -21,6 +21,7 @@ GetTransactionsHandler::GetTransactionsHandler(int subaccount, int first, int co
     , m_first(first)
     , m_count(count)
 {
+    setTraceAccount(subaccount);
 }
 
 QJsonArray GetTransactionsHandler::transactions() const
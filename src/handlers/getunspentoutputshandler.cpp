@@ -21,6 +21,7 @@ GetUnspentOutputsHandler::GetUnspentOutputsHandler(int subaccount, int num_confs
     , m_num_confs(num_confs)
     , m_all_coins(all_coins)
 {
+    setTraceAccount(subaccount);
 }
 
 QJsonObject GetUnspentOutputsHandler::unspentOutputs() const
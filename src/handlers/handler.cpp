@@ -6,10 +6,12 @@
 #include "resolver.h"
 #include "resolvers/signmessageresolver.h"
 #include "session.h"
+#include "tracer.h"
 #include "wallet.h"
 
 #include <gdk.h>
 
+#include <QThreadPool>
 #include <QtConcurrentRun>
 
 
@@ -50,13 +52,27 @@ static QJsonObject getErrorDetails()
     return result;
 }
 
+static QThreadPool* BackgroundThreadPool()
+{
+    static QThreadPool* pool = [] {
+        auto pool = new QThreadPool;
+        pool->setMaxThreadCount(1);
+        return pool;
+    }();
+    return pool;
+}
+
 void Handler::exec()
 {
     Q_ASSERT(!m_already_exec);
     m_already_exec = true;
 
     Q_ASSERT(!m_auth_handler);
-    setFuture(QtConcurrent::run([this] {
+    auto pool = m_background ? BackgroundThreadPool() : QThreadPool::globalInstance();
+    setFuture(QtConcurrent::run(pool, [this, background = m_background] {
+        if (background) QThread::currentThread()->setPriority(QThread::LowPriority);
+        Tracer::instance()->count("gdk calls");
+        TraceSpan span("gdk", metaObject()->className(), m_wallet, m_trace_account);
         call(m_wallet->m_session->m_session, &m_auth_handler);
         m_error_details = getErrorDetails();
         if (!m_error_details.isEmpty()) {
@@ -107,7 +123,10 @@ void Handler::step()
         const auto status = result.value("status").toString();
 
         if (status == "call") {
-            setFuture(QtConcurrent::run([this] {
+            auto pool = m_background ? BackgroundThreadPool() : QThreadPool::globalInstance();
+            setFuture(QtConcurrent::run(pool, [this] {
+                Tracer::instance()->count("gdk calls");
+                TraceSpan span("gdk", QString("%1 call").arg(metaObject()->className()), m_wallet, m_trace_account);
                 int res = GA_auth_handler_call(m_auth_handler);
                 Q_ASSERT(res == GA_OK);
             }));
@@ -139,6 +158,9 @@ void Handler::step()
         }
 
         if (status == "resolve_code") {
+            // The resolver span lasts until the code is resolved.
+            m_resolve_begin = Tracer::instance()->now();
+            m_resolve_name = result.contains("action") ? result.value("action").toString() : result.value("method").toString();
             auto instance = createResolver(result);
             if (instance) emit resolver(instance);
             return;
@@ -210,6 +232,10 @@ void Handler::resolve(const QJsonObject& data)
 void Handler::resolve(const QByteArray& data)
 {
     Q_ASSERT(m_auth_handler);
+    if (m_resolve_begin >= 0) {
+        Tracer::instance()->span("resolver", m_resolve_name, m_resolve_begin, m_wallet, m_trace_account);
+        m_resolve_begin = -1;
+    }
     int res = GA_auth_handler_resolve_code(m_auth_handler, data.constData());
     Q_ASSERT(res == GA_OK);
     step();
@@ -27,6 +27,10 @@ public:
     Wallet* wallet() const;
     void exec();
     void fail();
+    // Background handlers run on a single low priority thread so that read
+    // ahead never delays interactive calls. Set before exec(), clearing it
+    // later moves the remaining steps to the interactive pool.
+    void setBackground(bool background) { m_background = background; }
     const QJsonObject& result() const;
 public slots:
     void request(const QByteArray& method);
@@ -39,6 +43,9 @@ signals:
     void requestCode();
     void invalidCode();
     void resolver(Resolver* resolver);
+protected:
+    // Tags the trace spans of this handler with the account pointer.
+    void setTraceAccount(int pointer) { m_trace_account = pointer; }
 private:
     virtual void call(GA_session* session, GA_auth_handler** auth_handler) = 0;
     void step();
@@ -46,11 +53,15 @@ private:
     void setResult(const QJsonObject &result);
 private:
     bool m_already_exec{false};
+    bool m_background{false};
     Wallet* const m_wallet;
     GA_auth_handler* m_auth_handler{nullptr};
     TwoFactorResolver* m_two_factor_resolver{nullptr};
     QJsonObject m_result;
     QJsonObject m_error_details;
+    int m_trace_account{-1};
+    qint64 m_resolve_begin{-1};
+    QString m_resolve_name;
 };
 
 #endif // GREEN_HANDLER_H
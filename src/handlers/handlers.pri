@@ -6,6 +6,7 @@ HEADERS += \
     $$PWD/createtransactionhandler.h \
     $$PWD/deletewallethandler.h \
     $$PWD/getbalancehandler.h \
+    $$PWD/getfeeestimateshandler.h \
     $$PWD/gettransactionshandler.h \
     $$PWD/getaddresseshandler.h \
     $$PWD/getunspentoutputshandler.h \
@@ -22,6 +23,7 @@ SOURCES += \
     $$PWD/createtransactionhandler.cpp \
     $$PWD/deletewallethandler.cpp \
     $$PWD/getbalancehandler.cpp \
+    $$PWD/getfeeestimateshandler.cpp \
     $$PWD/gettransactionshandler.cpp \
     $$PWD/getaddresseshandler.cpp \
     $$PWD/getunspentoutputshandler.cpp \
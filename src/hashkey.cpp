@@ -0,0 +1,32 @@
+#include "hashkey.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+
+namespace {
+    int HexValue(ushort c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+} // namespace
+
+HashKey HashKey::fromString(const QString& value)
+{
+    HashKey key;
+    if (value.size() == 64) {
+        bool valid = true;
+        for (int i = 0; valid && i < 32; ++i) {
+            const int hi = HexValue(value.at(2 * i).unicode());
+            const int lo = HexValue(value.at(2 * i + 1).unicode());
+            valid = hi >= 0 && lo >= 0;
+            key.m_bytes[i] = static_cast<unsigned char>(hi << 4 | lo);
+        }
+        if (valid) return key;
+    }
+    const auto digest = QCryptographicHash::hash(value.toUtf8(), QCryptographicHash::Sha256);
+    std::memcpy(key.m_bytes.data(), digest.constData(), 32);
+    return key;
+}
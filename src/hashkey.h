@@ -0,0 +1,35 @@
+#ifndef GREEN_HASHKEY_H
+#define GREEN_HASHKEY_H
+
+#include <QHash>
+#include <QString>
+
+#include <array>
+#include <cstring>
+
+// Compact key for 32 byte hashes like txhashes and asset ids, which GDK
+// hands out as 64 character hex strings. Holds the raw bytes, a quarter of
+// the hex string, and since the bytes are already uniformly distributed the
+// first 8 are used as the hash.
+class HashKey
+{
+public:
+    HashKey() = default;
+    // Strings which aren't 64 hex characters are keyed by their SHA-256, so
+    // distinct strings still map to distinct keys.
+    static HashKey fromString(const QString& value);
+    bool operator==(const HashKey& other) const { return std::memcmp(m_bytes.data(), other.m_bytes.data(), 32) == 0; }
+    bool operator!=(const HashKey& other) const { return !(*this == other); }
+private:
+    std::array<unsigned char, 32> m_bytes{};
+    friend uint qHash(const HashKey& key, uint seed) noexcept;
+};
+
+inline uint qHash(const HashKey& key, uint seed = 0) noexcept
+{
+    quint64 prefix;
+    std::memcpy(&prefix, key.m_bytes.data(), sizeof(prefix));
+    return qHash(prefix, seed);
+}
+
+#endif // GREEN_HASHKEY_H
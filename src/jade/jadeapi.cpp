@@ -14,6 +14,7 @@
 #include "jadeserialimpl.h"
 
 #include "jadeapi.h"
+#include "tracer.h"
 
 // Useful for sending null values in tx-signing calls
 QVariant JadeAPI::NULL_CHANGE_ENTRY;
@@ -40,6 +41,13 @@ JadeAPI::JadeAPI(const QSerialPortInfo& deviceInfo, QObject *parent)
     // qDebug() << "JadeAPI::JadeAPI(serial)";
 }
 
+// Create with serial connection given the port system location
+JadeAPI::JadeAPI(const QString& systemLocation, QObject *parent)
+    : JadeAPI(new JadeSerialImpl(systemLocation, parent), parent) // temporary impl owership
+{
+    // qDebug() << "JadeAPI::JadeAPI(serial)";
+}
+
 // Create with BLE connection
 JadeAPI::JadeAPI(const QBluetoothDeviceInfo& deviceInfo, QObject *parent)
     : JadeAPI(new JadeBleImpl(deviceInfo, parent), parent) // temporary impl owership
@@ -60,6 +68,10 @@ JadeAPI::JadeAPI(JadeConnection *connection, QObject *parent)
     connect(m_jade, &JadeConnection::onNewMessageReceived,
             this, &JadeAPI::processResponseMessage);
 
+    // Requests awaiting response are never answered once disconnected
+    connect(m_jade, &JadeConnection::onDisconnected,
+            this, [this] { m_pendingSpans.clear(); });
+
     // Forward connection/disconnection signals from underlying connection
     connect(m_jade, &JadeConnection::onOpenError,
             this, &JadeAPI::onOpenError);
@@ -196,6 +208,11 @@ void JadeAPI::processResponseMessage(const QCborMap &msg)
     }
     const int id = msg["id"].toString().toInt();
 
+    if (m_pendingSpans.contains(id)) {
+        const auto span = m_pendingSpans.take(id);
+        Tracer::instance()->span("jade", span.first, span.second);
+    }
+
     if (msg.contains(QCborValue("result")) && msg["result"].isMap()
             && msg["result"].toMap().contains(QCborValue("http_request")))
     {
@@ -222,6 +239,8 @@ void JadeAPI::sendToJade(const QCborMap &msg)
 {
     // qInfo() << "JadeAPI::sendToJade() - Sending message ->" << Qt::endl << msg;
     Q_ASSERT(m_jade);
+    const int id = msg["id"].toString().toInt();
+    if (id > 0) m_pendingSpans.insert(id, { msg["method"].toString(), Tracer::instance()->now() });
     m_jade->send(msg);
 }
 
@@ -25,6 +25,10 @@ public:
     explicit JadeAPI(const QSerialPortInfo& deviceInfo,
                      QObject *parent = nullptr);
 
+    // Create JadeAPI on a serial connection given the port system location
+    explicit JadeAPI(const QString& systemLocation,
+                     QObject *parent = nullptr);
+
     // Create JadeAPI on a ble connection
     explicit JadeAPI(const QBluetoothDeviceInfo& deviceInfo,
                      QObject *parent = nullptr);
@@ -158,6 +162,9 @@ private:
     // Map of registered response handlers awaiting response
     QMap<int, ResponseHandler>  m_responseHandlers;
 
+    // Method and start time of requests awaiting response, for tracing
+    QMap<int, QPair<QString, qint64>> m_pendingSpans;
+
     // Underlying connection - lifetime managed by QObject hierarchy
     JadeConnection              *m_jade;
 };
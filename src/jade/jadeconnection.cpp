@@ -3,6 +3,7 @@
 #include <QCborValue>
 
 #include "jadeconnection.h"
+#include "tracer.h"
 
 JadeConnection::JadeConnection(QObject *parent)
     : QObject(parent),
@@ -44,12 +45,17 @@ int JadeConnection::send(const QCborMap &msg)
     const QByteArray bytes = msg.toCborValue().toCbor();
 
     // Pass to specific transport implementation
+    if (m_sentCounter.isEmpty()) m_sentCounter = QString("%1 bytes sent").arg(metaObject()->className());
+    Tracer::instance()->count(m_sentCounter, bytes.size());
     return writeImpl(bytes);
 }
 
 void JadeConnection::onDataReceived(const QByteArray &data) {
     // qDebug() << "JadeConnection::onDataReceived() -" << data.length() << "bytes received";
 
+    if (m_receivedCounter.isEmpty()) m_receivedCounter = QString("%1 bytes received").arg(metaObject()->className());
+    Tracer::instance()->count(m_receivedCounter, data.size());
+
     try {
         // Collect data
         m_unparsed.append(data);
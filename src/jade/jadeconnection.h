@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QByteArray>
+#include <QString>
 
 QT_FORWARD_DECLARE_CLASS(QCborMap);
 
@@ -47,6 +48,11 @@ private:
     // Unparsed bytes, received from underlying interface but not yet
     // parsed and published as a complete new cbor message received.
     QByteArray  m_unparsed;
+
+    // Tracer counter names, set on first use since the derived class name
+    // isn't available during construction.
+    QString     m_sentCounter;
+    QString     m_receivedCounter;
 };
 
 #endif // JADECONNECTIONIMPL_H
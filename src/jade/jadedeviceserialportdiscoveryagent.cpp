@@ -1,5 +1,6 @@
 #include "jadedeviceserialportdiscoveryagent.h"
 
+#include <QSocketNotifier>
 #include <QTimer>
 #include <QSerialPortInfo>
 
@@ -8,62 +9,173 @@
 
 #include "devicemanager.h"
 
+#ifdef Q_OS_LINUX
+#include <QFile>
+#include <QFileInfo>
+
+#include <errno.h>
+#include <libudev.h>
+#include <signal.h>
+#endif
+
+// Silicon Laboratories CP2104 USB to UART
+#define JADE_VENDOR_ID 0x10c4
+#define JADE_PRODUCT_ID 0xea60
+
 JadeDeviceSerialPortDiscoveryAgent::JadeDeviceSerialPortDiscoveryAgent(QObject* parent)
     : QObject(parent)
 {
+#ifdef Q_OS_LINUX
+    // serial ports are tracked with udev hotplug events, the monitor is
+    // enabled before the initial scan so that no event is missed
+    m_udev = udev_new();
+    Q_ASSERT(m_udev);
+    m_monitor = udev_monitor_new_from_netlink(m_udev, "udev");
+    Q_ASSERT(m_monitor);
+    int res = udev_monitor_filter_add_match_subsystem_devtype(m_monitor, "tty", nullptr);
+    Q_ASSERT(res >= 0);
+    res = udev_monitor_enable_receiving(m_monitor);
+    Q_ASSERT(res >= 0);
+
+    m_notifier = new QSocketNotifier(udev_monitor_get_fd(m_monitor), QSocketNotifier::Read, this);
+    m_notifier->setEnabled(true);
+    connect(m_notifier, &QSocketNotifier::activated, this, [this] {
+        handleMonitorEvent();
+    });
+    scan();
+#else
     auto timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, [this] {
-        auto devices = m_devices;
-        m_devices.clear();
-
-        for (const auto &info : QSerialPortInfo::availablePorts()) {
-            const auto system_location = info.systemLocation();
-            if (m_failed_locations.contains(system_location)) continue;
-
-            // filter for Silicon Laboratories USB to UART
-            if (info.vendorIdentifier() != 0x10c4) continue;
-            if (info.productIdentifier() != 0xea60) continue;
-
-            auto device = devices.take(system_location);
-            if (!device) {
-                auto api = new JadeAPI(info);
-                device = new JadeDevice(api, this);
-                api->setParent(device);
-                device->m_system_location = system_location;
-                connect(api, &JadeAPI::onConnected, this, [this, device] {
-                    device->m_jade->getVersionInfo([this, device](const QVariantMap& data) {
-                        const auto result = data.value("result").toMap();
-                        device->setVersionInfo(result);
-                        DeviceManager::instance()->addDevice(device);
-                    });
-                });
-                connect(api, &JadeAPI::onOpenError, this, [this, device] {
-                    m_failed_locations.insert(device->m_system_location);
-                });
-                connect(api, &JadeAPI::onDisconnected, this, [this, device] {
-                    if (m_devices.take(device->m_system_location)) {
-                        DeviceManager::instance()->removeDevice(device);
-                        delete device;
-                    }
-                });
-                m_devices.insert(system_location, device);
-                api->connectDevice();
-            } else if (device->m_jade->isConnected()) {
-                m_devices.insert(system_location, device);
-            } else {
-                devices.insert(system_location, device);
-            }
+    connect(timer, &QTimer::timeout, this, &JadeDeviceSerialPortDiscoveryAgent::scan);
+    timer->start(2000);
+#endif
+}
+
+JadeDeviceSerialPortDiscoveryAgent::~JadeDeviceSerialPortDiscoveryAgent()
+{
+#ifdef Q_OS_LINUX
+    delete m_notifier;
+    udev_monitor_unref(m_monitor);
+    udev_unref(m_udev);
+#endif
+}
+
+void JadeDeviceSerialPortDiscoveryAgent::scan()
+{
+    auto devices = m_devices;
+    m_devices.clear();
+
+    for (const auto &info : QSerialPortInfo::availablePorts()) {
+        const auto system_location = info.systemLocation();
+        if (m_failed_locations.contains(system_location)) continue;
+
+        if (info.vendorIdentifier() != JADE_VENDOR_ID) continue;
+        if (info.productIdentifier() != JADE_PRODUCT_ID) continue;
+
+        auto device = devices.take(system_location);
+        if (!device) {
+            // isBusy only checks the port lock file, which avoids opening
+            // ports that are already in use by another process
+            if (info.isBusy()) continue;
+            addDevice(system_location, new JadeAPI(info));
+        } else if (device->m_jade->isConnected()) {
+            m_devices.insert(system_location, device);
+        } else {
+            devices.insert(system_location, device);
         }
+    }
+
+    if (devices.empty()) return;
 
-        if (devices.empty()) return;
+    while (!devices.empty()) {
+        const auto system_location = devices.firstKey();
+        auto device = devices.take(system_location);
+        DeviceManager::instance()->removeDevice(device);
+        device->m_jade->disconnectDevice();
+        delete device;
+    }
+}
 
-        while (!devices.empty()) {
-            const auto system_location = devices.firstKey();
-            auto device = devices.take(system_location);
+void JadeDeviceSerialPortDiscoveryAgent::addDevice(const QString& system_location, JadeAPI* api)
+{
+    auto device = new JadeDevice(api, this);
+    api->setParent(device);
+    device->m_system_location = system_location;
+    connect(api, &JadeAPI::onConnected, this, [this, device] {
+        device->m_jade->getVersionInfo([this, device](const QVariantMap& data) {
+            const auto result = data.value("result").toMap();
+            device->setVersionInfo(result);
+            DeviceManager::instance()->addDevice(device);
+        });
+    });
+    connect(api, &JadeAPI::onOpenError, this, [this, device] {
+        m_failed_locations.insert(device->m_system_location);
+    });
+    connect(api, &JadeAPI::onDisconnected, this, [this, device] {
+        if (m_devices.take(device->m_system_location)) {
             DeviceManager::instance()->removeDevice(device);
-            device->m_jade->disconnectDevice();
             delete device;
         }
     });
-    timer->start(2000);
+    m_devices.insert(system_location, device);
+    api->connectDevice();
+}
+
+void JadeDeviceSerialPortDiscoveryAgent::removeDevice(const QString& system_location)
+{
+    // a port that failed to open can be retried once it is plugged again
+    m_failed_locations.remove(system_location);
+    auto device = m_devices.take(system_location);
+    if (!device) return;
+    DeviceManager::instance()->removeDevice(device);
+    device->m_jade->disconnectDevice();
+    delete device;
+}
+
+#ifdef Q_OS_LINUX
+bool JadeDeviceSerialPortDiscoveryAgent::isJadeDevice(udev_device* handle)
+{
+    auto usb_dev = udev_device_get_parent_with_subsystem_devtype(handle, "usb", "usb_device");
+    if (!usb_dev) return false;
+    const uint32_t vendor_id = QString::fromLocal8Bit(udev_device_get_sysattr_value(usb_dev, "idVendor")).toUInt(nullptr, 16);
+    const uint32_t product_id = QString::fromLocal8Bit(udev_device_get_sysattr_value(usb_dev, "idProduct")).toUInt(nullptr, 16);
+    return vendor_id == JADE_VENDOR_ID && product_id == JADE_PRODUCT_ID;
+}
+
+bool JadeDeviceSerialPortDiscoveryAgent::isPortLocked(const QString& system_location)
+{
+    // UUCP style lock files, as QSerialPort creates them, checked directly
+    // since QSerialPortInfo would enumerate all ports
+    const auto name = QStringLiteral("LCK..") + QFileInfo(system_location).fileName();
+    for (const char* dir : { "/var/lock", "/etc/locks", "/var/spool/locks", "/var/spool/uucp", "/tmp", "/var/tmp", "/var/lock/lockdev", "/run/lock" }) {
+        QFile file(QString::fromLatin1(dir) + QLatin1Char('/') + name);
+        if (!file.open(QFile::ReadOnly | QFile::Text)) continue;
+        const qint64 pid = file.readLine().trimmed().toLongLong();
+        // a lock left behind by a process that is gone doesn't count
+        if (pid > 0 && ::kill(pid, 0) == -1 && errno == ESRCH) continue;
+        return true;
+    }
+    return false;
+}
+
+void JadeDeviceSerialPortDiscoveryAgent::handleMonitorEvent()
+{
+    udev_device* handle = udev_monitor_receive_device(m_monitor);
+    if (!handle) return;
+
+    const char* action = udev_device_get_action(handle);
+    const char* devnode = udev_device_get_devnode(handle);
+    if (action && devnode) {
+        const auto system_location = QString::fromLocal8Bit(devnode);
+        if (strcmp(action, "add") == 0) {
+            // services like ModemManager may grab a new tty right away, check
+            // the port lock file as the initial scan does
+            if (!m_devices.contains(system_location) && isJadeDevice(handle) && !isPortLocked(system_location)) {
+                addDevice(system_location, new JadeAPI(system_location));
+            }
+        } else if (strcmp(action, "remove") == 0) {
+            removeDevice(system_location);
+        }
+    }
+    udev_device_unref(handle);
 }
+#endif
@@ -6,6 +6,14 @@
 #include <QSet>
 
 QT_FORWARD_DECLARE_CLASS(JadeDevice)
+QT_FORWARD_DECLARE_CLASS(JadeAPI)
+QT_FORWARD_DECLARE_CLASS(QSocketNotifier)
+
+#ifdef Q_OS_LINUX
+struct udev;
+struct udev_device;
+struct udev_monitor;
+#endif
 
 class JadeDeviceSerialPortDiscoveryAgent : public QObject
 {
@@ -13,7 +21,19 @@ class JadeDeviceSerialPortDiscoveryAgent : public QObject
     QML_ELEMENT
 public:
     explicit JadeDeviceSerialPortDiscoveryAgent(QObject* parent = nullptr);
+    ~JadeDeviceSerialPortDiscoveryAgent();
 private:
+    void scan();
+    void addDevice(const QString& system_location, JadeAPI* api);
+    void removeDevice(const QString& system_location);
+#ifdef Q_OS_LINUX
+    void handleMonitorEvent();
+    static bool isJadeDevice(udev_device* handle);
+    static bool isPortLocked(const QString& system_location);
+    udev* m_udev{nullptr};
+    udev_monitor* m_monitor{nullptr};
+    QSocketNotifier* m_notifier{nullptr};
+#endif
     QMap<QString, JadeDevice*> m_devices;
     QSet<QString> m_failed_locations;
 };
@@ -8,6 +8,19 @@ JadeSerialImpl::JadeSerialImpl(const QSerialPortInfo &deviceInfo,
                                QObject *parent)
     : JadeConnection(parent),
       m_serial(new QSerialPort(deviceInfo, this)) // take ownership
+{
+    setupSerialPort();
+}
+
+JadeSerialImpl::JadeSerialImpl(const QString &systemLocation,
+                               QObject *parent)
+    : JadeConnection(parent),
+      m_serial(new QSerialPort(systemLocation, this)) // take ownership
+{
+    setupSerialPort();
+}
+
+void JadeSerialImpl::setupSerialPort()
 {
     Q_ASSERT(m_serial);
 
@@ -12,6 +12,8 @@ class JadeSerialImpl : public JadeConnection
 public:
     explicit JadeSerialImpl(const QSerialPortInfo& deviceInfo,
                             QObject *parent = nullptr);
+    explicit JadeSerialImpl(const QString& systemLocation,
+                            QObject *parent = nullptr);
     ~JadeSerialImpl();
 
 private slots:
@@ -19,6 +21,9 @@ private slots:
     void onSerialDataReady();
 
 private:
+    // Set expected connection parameters
+    void setupSerialPort();
+
     // Manage connection
     bool isConnectedImpl();
     void connectDeviceImpl();
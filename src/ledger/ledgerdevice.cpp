@@ -39,10 +39,12 @@ QString LedgerDevice::name() const
     }
 }
 
-DeviceCommand* LedgerDevice::exchange(const QByteArray& data) {
-    auto command = new LedgerGenericCommand(this, data);
+void LedgerDevice::exchange(const QByteArray& data, QObject* context, const DeviceCommand::FinishedHandler& finished, const DeviceCommand::ErrorHandler& error)
+{
+    auto command = m_command_pool.acquire(this);
+    command->setData(data);
+    command->then(context, finished, error);
     command->exec();
-    return command;
 }
 
 GetWalletPublicKeyActivity *LedgerDevice::getWalletPublicKey(Network* network, const QVector<uint32_t>& path)
@@ -117,10 +119,8 @@ GetFirmwareActivity::GetFirmwareActivity(LedgerDevice* device)
 
 void GetFirmwareActivity::exec()
 {
-    auto command = m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_FIRMWARE_VERSION, 0x00, 0x00));
-    connect(command, &Command::finished, [this, command] {
-        command->deleteLater();
-        QDataStream stream(command->m_response);
+    m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_FIRMWARE_VERSION, 0x00, 0x00), this, [this](const QByteArray& response) {
+        QDataStream stream(response);
         stream >> m_features >> m_arch >> m_fw_major >> m_fw_minor >> m_fw_patch >> m_loader_major >> m_loader_minor;
         Q_ASSERT(m_arch == 0x30);
         //    0x01 : public keys are compressed (otherwise not compressed)
@@ -131,9 +131,7 @@ void GetFirmwareActivity::exec()
         //    0x20 : implementation running on a Trusted Execution Environment
         qDebug() << m_features << m_arch << m_fw_major << m_fw_minor << m_fw_patch << m_loader_major << m_loader_minor;
         finish();
-    });
-    connect(command, &Command::error, [this, command] {
-        command->deleteLater();
+    }, [this] {
         fail();
     });
 }
@@ -156,11 +154,8 @@ SemVer GetAppActivity::version() const
 
 void GetAppActivity::exec()
 {
-    auto command = m_device->exchange(apdu(BTCHIP_CLA_COMMON_SDK, BTCHIP_INS_GET_APP_NAME_AND_VERSION, 0x00, 0x00));
-    connect(command, &Command::finished, [this, command] {
-        command->deleteLater();
-
-        QDataStream stream(command->m_response);
+    m_device->exchange(apdu(BTCHIP_CLA_COMMON_SDK, BTCHIP_INS_GET_APP_NAME_AND_VERSION, 0x00, 0x00), this, [this](const QByteArray& response) {
+        QDataStream stream(response);
         uint8_t format;
         stream >> format;
 
@@ -181,9 +176,7 @@ void GetAppActivity::exec()
         m_version = SemVer::parse(version_string);
 
         finish();
-    });
-    connect(command, &Command::error, [this, command] {
-        command->deleteLater();
+    }, [this] {
         fail();
     });
 }
@@ -203,8 +196,8 @@ DevicePrivate* DevicePrivate::get(LedgerDevice* device)
     return device->d;
 }
 
-LedgerGenericCommand::LedgerGenericCommand(LedgerDevice *device, const QByteArray &data)
-    : GenericCommand(device, data)
+LedgerGenericCommand::LedgerGenericCommand(LedgerDevice *device)
+    : GenericCommand(device)
     , m_device(device)
 {
 }
@@ -214,6 +207,57 @@ void LedgerGenericCommand::exec()
     DevicePrivate::get(m_device)->exchange(this);
 }
 
+void LedgerGenericCommand::release()
+{
+    m_device->m_command_pool.release(this);
+}
+
+LedgerApduStream::LedgerApduStream(LedgerDevice* device)
+    : DeviceCommand(device)
+    , m_device(device)
+{
+}
+
+void LedgerApduStream::add(const QByteArray& apdu, const ResponseHandler& handler)
+{
+    m_offsets.append(m_buffer.size());
+    m_handlers.append(handler);
+    m_buffer.append(apdu);
+}
+
+QByteArray LedgerApduStream::payload() const
+{
+    Q_ASSERT(m_index < m_offsets.size());
+    const int begin = m_offsets.at(m_index);
+    const int end = m_index + 1 < m_offsets.size() ? m_offsets.at(m_index + 1) : m_buffer.size();
+    return m_buffer.mid(begin, end - begin);
+}
+
+bool LedgerApduStream::parse(const QByteArray& data)
+{
+    const auto& handler = m_handlers.at(m_index);
+    if (handler && context()) handler(data);
+    return true;
+}
+
+bool LedgerApduStream::next()
+{
+    if (++m_index == m_offsets.size()) return false;
+    // this command is at the head of the queue and is dequeued after this
+    // returns, queue it right behind so that no other command is exchanged
+    // in the middle of the stream
+    auto& queue = DevicePrivate::get(m_device)->queue;
+    Q_ASSERT(!queue.empty() && queue.head() == this);
+    queue.insert(1, this);
+    return true;
+}
+
+void LedgerApduStream::exec()
+{
+    if (m_offsets.isEmpty()) return complete(true);
+    DevicePrivate::get(m_device)->exchange(this);
+}
+
 void varInt(QDataStream &stream, int64_t i)
 {
     switch (varIntSize(i)) {
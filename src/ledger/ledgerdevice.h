@@ -68,8 +68,32 @@ class LedgerGenericCommand : public GenericCommand
 {
     LedgerDevice* const m_device;
 public:
-    LedgerGenericCommand(LedgerDevice* device, const QByteArray& data);
+    LedgerGenericCommand(LedgerDevice* device);
     void exec() override;
+protected:
+    void release() override;
+};
+
+// APDUs stored back to back in a single buffer and exchanged in order by a
+// single command, each response is passed to the handler given to add().
+class LedgerApduStream : public DeviceCommand
+{
+public:
+    typedef std::function<void(const QByteArray&)> ResponseHandler;
+    LedgerApduStream(LedgerDevice* device);
+    void add(const QByteArray& apdu, const ResponseHandler& handler = nullptr);
+    int count() const { return m_offsets.size(); }
+    QByteArray payload() const override;
+    using DeviceCommand::parse;
+    bool parse(const QByteArray& data) override;
+    bool next() override;
+    void exec() override;
+private:
+    LedgerDevice* const m_device;
+    QByteArray m_buffer;
+    QVector<int> m_offsets;
+    QVector<ResponseHandler> m_handlers;
+    int m_index{0};
 };
 
 class DevicePrivate;
@@ -85,7 +109,7 @@ public:
     Type type() const override;
     QString name() const override;
 
-    DeviceCommand* exchange(const QByteArray& data);
+    void exchange(const QByteArray& data, QObject* context, const DeviceCommand::FinishedHandler& finished, const DeviceCommand::ErrorHandler& error);
 
     GetWalletPublicKeyActivity* getWalletPublicKey(Network* network, const QVector<uint32_t>& path) override;
     SignMessageActivity* signMessage(const QString& message, const QVector<uint32_t>& path) override;
@@ -103,7 +127,9 @@ public:
 
 private:
     friend class DevicePrivate;
+    friend class LedgerGenericCommand;
     DevicePrivate* const d;
+    CommandPool<LedgerGenericCommand> m_command_pool;
 };
 
 #endif // GREEN_LEDGERDEVICE_H
@@ -16,14 +16,10 @@ QByteArray LedgerGetBlindingKeyActivity::publicKey() const
 
 void LedgerGetBlindingKeyActivity::exec()
 {
-    auto command = m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_BLINDING_KEY, 0x00, 0x00, ParseByteArray(m_script)));
-    connect(command, &Command::finished, [this, command] {
-        command->deleteLater();
-        m_public_key = compressPublicKey(command->m_response);
+    m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_BLINDING_KEY, 0x00, 0x00, ParseByteArray(m_script)), this, [this](const QByteArray& response) {
+        m_public_key = compressPublicKey(response);
         finish();
-    });
-    connect(command, &Command::error, [this, command] {
-        command->deleteLater();
+    }, [this] {
         fail();
     });
 }
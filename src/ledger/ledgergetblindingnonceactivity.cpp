@@ -25,15 +25,11 @@ void LedgerGetBlindingNonceActivity::exec()
                 (unsigned char*) pubkey_uncompressed.data(), pubkey_uncompressed.size());
     Q_ASSERT(res == WALLY_OK);
 
-    auto command = m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_NONCE, 0x00, 0x00, pubkey_uncompressed + m_script));
-    connect(command, &Command::finished, this, [this, command] {
-        command->deleteLater();
-        Q_ASSERT(command->m_response.length() == 32);
-        m_nonce = command->m_response;
+    m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_NONCE, 0x00, 0x00, pubkey_uncompressed + m_script), this, [this](const QByteArray& response) {
+        Q_ASSERT(response.length() == 32);
+        m_nonce = response;
         finish();
-    });
-    connect(command, &Command::error, this, [this, command] {
-        command->deleteLater();
+    }, [this] {
         fail();
     });
 }
@@ -36,11 +36,9 @@ void LedgerGetWalletPublicKeyActivity::exec()
     QDataStream s(&path, QIODevice::WriteOnly);
     s << uint8_t(m_path.size());
     for (auto p : m_path) s << uint32_t(p);
-    auto cmd = m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_WALLET_PUBLIC_KEY, 0x0, 0, path));
-    connect(cmd, &Command::finished, this, [this, cmd] {
-        cmd->deleteLater();
+    m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_WALLET_PUBLIC_KEY, 0x0, 0, path), this, [this](const QByteArray& response) {
         uint32_t version = m_network->data().value("mainnet").toBool() ? BIP32_VER_MAIN_PUBLIC : BIP32_VER_TEST_PUBLIC;
-        QDataStream stream(cmd->m_response);
+        QDataStream stream(response);
         uint8_t pubkey_len, address_len;
         stream >> pubkey_len;
         QByteArray pubkey(pubkey_len, 0);
@@ -78,9 +76,7 @@ void LedgerGetWalletPublicKeyActivity::exec()
 
         wally_free_string(base58);
         finish();
-    });
-    connect(cmd, &Command::error, this, [this, cmd] {
-        cmd->deleteLater();
+    }, [this] {
         fail();
     });
 }
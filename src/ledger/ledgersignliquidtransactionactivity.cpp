@@ -42,9 +42,7 @@ LedgerSignLiquidTransactionActivity::LedgerSignLiquidTransactionActivity(const Q
     , m_transaction(transaction)
     , m_inputs(signing_inputs)
     , m_outputs(outputs)
-    , m_batch(new CommandBatch)
 {
-    connect(m_batch, &Command::error, this, [this] { fail(); });
 }
 
 void LedgerSignLiquidTransactionActivity::exec()
@@ -64,137 +62,151 @@ void LedgerSignLiquidTransactionActivity::exec()
     Q_ASSERT(input0.contains("prevout_script"));
     const auto script0 = ParseByteArray(input0.value("prevout_script"));
 
-    startUntrustedTransaction(true, 0, m_hw_inputs, m_hw_sequences, script0);
-
     for (const auto input : m_inputs) {
         m_values.append(ParseSatoshi(input.toObject().value("satoshi")));
         m_abfs.append(ReverseByteArray(ParseByteArray(input.toObject().value("assetblinder"))));
         m_vbfs.append(ReverseByteArray(ParseByteArray(input.toObject().value("amountblinder"))));
     }
 
-    getLiquidCommitment(0);
+    // responses are stored by output index since outputs without script
+    // don't have commitments nor blinders
+    for (int i = 0; i < m_outputs.size(); ++i) {
+        m_commitments.append(QByteArray());
+        m_abfs.append(QByteArray());
+        m_vbfs.append(QByteArray());
+    }
 
-    m_batch->exec();
+    auto stream = new LedgerApduStream(m_device);
+    startUntrustedTransaction(stream, true, 0, m_hw_inputs, m_hw_sequences, script0);
+    getLiquidCommitments(stream, 0);
 }
 
-void LedgerSignLiquidTransactionActivity::startUntrustedTransaction(bool new_transaction, int input_index, const QList<QByteArray>& inputs, const QList<QByteArray>& sequences, const QByteArray& redeem_script)
+void LedgerSignLiquidTransactionActivity::add(LedgerApduStream* stream, const QByteArray& apdu, const LedgerApduStream::ResponseHandler& handler)
+{
+    stream->add(apdu, [this, handler](const QByteArray& response) {
+        exchange_count ++;
+        progress()->setValue(exchange_count);
+        if (handler) handler(response);
+    });
+}
+
+void LedgerSignLiquidTransactionActivity::run(LedgerApduStream* stream, const std::function<void()>& done)
+{
+    stream->then(this, [done](const QByteArray&) {
+        done();
+    }, [this] {
+        fail();
+    });
+    stream->exec();
+}
+
+void LedgerSignLiquidTransactionActivity::startUntrustedTransaction(LedgerApduStream* stream, bool new_transaction, int input_index, const QList<QByteArray>& inputs, const QList<QByteArray>& sequences, const QByteArray& redeem_script)
 {
     Q_ASSERT(inputs.size() == sequences.size());
     {
         QByteArray data;
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream.setByteOrder(QDataStream::LittleEndian);
+        QDataStream s(&data, QIODevice::WriteOnly);
+        s.setByteOrder(QDataStream::LittleEndian);
         uint32_t version = m_transaction.value("transaction_version").toDouble();
-        stream << version << varint<uint32_t>(inputs.size());
-        exchange(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x00, new_transaction ? 0x06 : 0x80, data));
+        s << version << varint<uint32_t>(inputs.size());
+        add(stream, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x00, new_transaction ? 0x06 : 0x80, data));
     }
     for (int i = 0; i < inputs.size(); ++i) {
-        QByteArray script = i == input_index ? redeem_script : QByteArray();
-
-        QByteArray data;
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream.setByteOrder(QDataStream::LittleEndian);
-        stream << uint8_t(0x03);
-        stream.writeRawData(inputs.at(i).data(), inputs.at(i).size());
-        stream << varint<uint32_t>(script.size());
-
-        exchange(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x80, 0x00, data));
-        exchange(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x80, 0x00, script + sequences.at(i)));
+        hashInput(stream, inputs.at(i), i == input_index ? redeem_script : QByteArray(), sequences.at(i));
     }
 }
 
-void LedgerSignLiquidTransactionActivity::getLiquidCommitment(int output_index)
+void LedgerSignLiquidTransactionActivity::hashInput(LedgerApduStream* stream, const QByteArray& input, const QByteArray& script, const QByteArray& sequence)
 {
-    if (output_index == m_outputs.size()) {
-        return finalizeLiquidInputFull();
-    }
+    QByteArray data;
+    QDataStream s(&data, QIODevice::WriteOnly);
+    s.setByteOrder(QDataStream::LittleEndian);
+    s << uint8_t(0x03);
+    s.writeRawData(input.data(), input.size());
+    s << varint<uint32_t>(script.size());
+
+    add(stream, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x80, 0x00, data));
+    add(stream, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x80, 0x00, script + sequence));
+}
 
-    Q_ASSERT(output_index < m_outputs.size());
-    const auto output = m_outputs.at(output_index).toObject();
-    const bool last = (output_index + 2) == m_outputs.size();
+void LedgerSignLiquidTransactionActivity::getLiquidCommitments(LedgerApduStream* stream, int output_index)
+{
+    for (; output_index < m_outputs.size(); ++output_index) {
+        const auto output = m_outputs.at(output_index).toObject();
+        const bool last = (output_index + 2) == m_outputs.size();
 
-    Q_ASSERT(output.contains("script"));
-    if (output.value("script").toString().isEmpty()) {
-        m_commitments.append(QByteArray());
-        m_abfs.append(QByteArray());
-        m_vbfs.append(QByteArray());
-        return getLiquidCommitment(output_index + 1);
-    }
+        Q_ASSERT(output.contains("script"));
+        if (output.value("script").toString().isEmpty()) continue;
 
-    Q_ASSERT(output.contains("satoshi"));
-    const quint64 value = ParseSatoshi(output.value("satoshi"));
-    m_values.append(value);
+        Q_ASSERT(output.contains("satoshi"));
+        const quint64 value = ParseSatoshi(output.value("satoshi"));
+        m_values.append(value);
 
-    Q_ASSERT(output.contains("asset_id"));
-    const auto asset_id = ParseByteArray(output.value("asset_id"));
-    Q_ASSERT(asset_id.size() == 32);
+        Q_ASSERT(output.contains("asset_id"));
+        const auto asset_id = ParseByteArray(output.value("asset_id"));
+        Q_ASSERT(asset_id.size() == 32);
 
-    if (last) {
-        QByteArray data;
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream.setByteOrder(QDataStream::BigEndian);
-        stream << uint32_t(output_index);
-        auto c = exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_BLINDING_FACTOR, 0x01, 0x00, data));
-        connect(c, &Command::finished, [this, c, output_index, value, asset_id] {
-            Q_ASSERT(c->m_response.size() == 32);
-            m_abfs.append(c->m_response);
+        const int blinder_index = m_inputs.size() + output_index;
 
+        if (last) {
             QByteArray data;
-            QDataStream stream(&data, QIODevice::WriteOnly);
-            stream.setByteOrder(QDataStream::BigEndian);
+            QDataStream s(&data, QIODevice::WriteOnly);
+            s.setByteOrder(QDataStream::BigEndian);
+            s << uint32_t(output_index);
+            add(stream, apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_BLINDING_FACTOR, 0x01, 0x00, data), [this, blinder_index](const QByteArray& response) {
+                Q_ASSERT(response.size() == 32);
+                m_abfs[blinder_index] = response;
+            });
 
-            stream.writeRawData(asset_id.data(), asset_id.length());
-            stream << quint64(value) << uint32_t(output_index);
-
-            const auto values = m_values.toVector();
-            const auto abf = m_abfs.join();
-            const auto vbf = m_vbfs.join();
-
-            char final_vbf[BLINDING_FACTOR_LEN];
-            int ret = wally_asset_final_vbf(
-                        (const uint64_t*) values.data(), values.size(),
-                        m_inputs.size(),
-                        (const unsigned char*) abf.data(), abf.size(),
-                        (const unsigned char*) vbf.data(), vbf.size(),
-                        (unsigned char*) final_vbf, BLINDING_FACTOR_LEN);
-            Q_ASSERT(ret == WALLY_OK);
-            m_vbfs.append(QByteArray(final_vbf, BLINDING_FACTOR_LEN));
-            stream.writeRawData(final_vbf, BLINDING_FACTOR_LEN);
-
-            auto c = exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_COMMITMENTS, 0x02, 0x00, data));
-            connect(c, &Command::finished, [this, c, output_index] {
-                m_commitments.append(c->m_response);
-                getLiquidCommitment(output_index + 1);
+            // the final value blinder depends on all the previous blinders,
+            // so the stream is exchanged up to here before continuing
+            return run(stream, [this, output_index, blinder_index, value, asset_id] {
+                QByteArray data;
+                QDataStream s(&data, QIODevice::WriteOnly);
+                s.setByteOrder(QDataStream::BigEndian);
+
+                s.writeRawData(asset_id.data(), asset_id.length());
+                s << quint64(value) << uint32_t(output_index);
+
+                const auto values = m_values.toVector();
+                const auto abf = m_abfs.join();
+                const auto vbf = m_vbfs.join();
+
+                char final_vbf[BLINDING_FACTOR_LEN];
+                int ret = wally_asset_final_vbf(
+                            (const uint64_t*) values.data(), values.size(),
+                            m_inputs.size(),
+                            (const unsigned char*) abf.data(), abf.size(),
+                            (const unsigned char*) vbf.data(), vbf.size(),
+                            (unsigned char*) final_vbf, BLINDING_FACTOR_LEN);
+                Q_ASSERT(ret == WALLY_OK);
+                m_vbfs[blinder_index] = QByteArray(final_vbf, BLINDING_FACTOR_LEN);
+                s.writeRawData(final_vbf, BLINDING_FACTOR_LEN);
+
+                auto stream = new LedgerApduStream(m_device);
+                add(stream, apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_COMMITMENTS, 0x02, 0x00, data), [this, output_index](const QByteArray& response) {
+                    m_commitments[output_index] = response;
+                });
+                getLiquidCommitments(stream, output_index + 1);
             });
-        });
-    } else {
+        }
+
         QByteArray data;
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream.setByteOrder(QDataStream::BigEndian);
-
-        stream.writeRawData(asset_id.data(), asset_id.length());
-        stream << quint64(value) << uint32_t(output_index);
-
-        auto c = exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_COMMITMENTS, 0x01, 0x00, data));
-        connect(c, &Command::finished, [this, c, output_index] {
-            Q_ASSERT(c->m_response.size() >= 64);
-            m_commitments.append(c->m_response);
-            m_abfs.append(c->m_response.mid(0, 32));
-            m_vbfs.append(c->m_response.mid(32, 32));
-            getLiquidCommitment(output_index + 1);
+        QDataStream s(&data, QIODevice::WriteOnly);
+        s.setByteOrder(QDataStream::BigEndian);
+
+        s.writeRawData(asset_id.data(), asset_id.length());
+        s << quint64(value) << uint32_t(output_index);
+
+        add(stream, apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_COMMITMENTS, 0x01, 0x00, data), [this, output_index, blinder_index](const QByteArray& response) {
+            Q_ASSERT(response.size() >= 64);
+            m_commitments[output_index] = response;
+            m_abfs[blinder_index] = response.mid(0, 32);
+            m_vbfs[blinder_index] = response.mid(32, 32);
         });
     }
-}
 
-DeviceCommand *LedgerSignLiquidTransactionActivity::exchange(const QByteArray& data)
-{
-    auto command = new LedgerGenericCommand(m_device, data);
-    connect(command, &Command::finished, [this] {
-       exchange_count ++;
-       progress()->setValue(exchange_count);
-    });
-    m_batch->add(command);
-    return command;
+    run(stream, [this] { finalizeLiquidInputFull(); });
 }
 
 QList<QPair<QJsonObject, QByteArray>> LedgerSignLiquidTransactionActivity::outputLiquidBytes()
@@ -263,34 +275,24 @@ QList<QPair<QJsonObject, QByteArray>> LedgerSignLiquidTransactionActivity::outpu
 
 void LedgerSignLiquidTransactionActivity::finalizeLiquidInputFull()
 {
+    auto stream = new LedgerApduStream(m_device);
+
     int i = 0;
     m_output_liquid_bytes = outputLiquidBytes();
     for (const auto& data : m_output_liquid_bytes) {
-        auto c = exchange(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_FINALIZE_FULL, i == m_output_liquid_bytes.size()-1 ? 0x80 : 0x00, 0x00, data.second));
-        connect(c, &Command::finished, [this, i] {
+        add(stream, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_FINALIZE_FULL, i == m_output_liquid_bytes.size()-1 ? 0x80 : 0x00, 0x00, data.second), [this, i](const QByteArray&) {
             if (i + 1 < m_output_liquid_bytes.size()) {
                 setMessage(m_output_liquid_bytes.at(i + 1).first);
             } else {
                 setMessage({});
             }
-            // qDebug() << "RECEIVE BTCHIP_INS_HASH_INPUT_FINALIZE_FULL" << i << c->m_response.toHex();
-        });
-        connect(c, &Command::error, [] {
-            // qDebug() << "RECEIVE BTCHIP_INS_HASH_INPUT_FINALIZE_FULL" << i << "!!!!! ERROR !!!!!";
         });
-
         i++;
     }
 
     {
         QByteArray data(m_inputs.size(), 0);
-        auto c = exchange(apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_ISSUANCE_INFORMATION, 0x80, 0x00, data));
-        connect(c, &Command::finished, [c] {
-//            qDebug() << "RECEIVE BTCHIP_INS_GET_LIQUID_ISSUANCE_INFORMATION" << c->m_response.toHex();
-        });
-        connect(c, &Command::error, [i] {
-//            qDebug() << "RECEIVE BTCHIP_INS_GET_LIQUID_ISSUANCE_INFORMATION" << "!!!!! ERROR !!!!!";
-        });
+        add(stream, apdu(BTCHIP_CLA, BTCHIP_INS_GET_LIQUID_ISSUANCE_INFORMATION, 0x80, 0x00, data));
     }
 
     for (i = 0; i < m_outputs.size(); ++i) {
@@ -306,47 +308,54 @@ void LedgerSignLiquidTransactionActivity::finalizeLiquidInputFull()
 
     const uint32_t locktime = ParseLocktime(m_transaction.value("transaction_locktime"));
 
+    // each input is hashed again on its own before being signed, the hash
+    // input start header and the hash sign suffix are the same for all
+    // inputs so they are serialized once
+    QByteArray header;
+    {
+        QByteArray data;
+        QDataStream s(&data, QIODevice::WriteOnly);
+        s.setByteOrder(QDataStream::LittleEndian);
+        uint32_t version = m_transaction.value("transaction_version").toDouble();
+        s << version << varint<uint32_t>(1);
+        header = apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x00, 0x80, data);
+    }
+    QByteArray sign_suffix;
+    {
+        QDataStream s(&sign_suffix, QIODevice::WriteOnly);
+        s.setByteOrder(QDataStream::BigEndian);
+
+        // TODO android implementation uses empty pin, like:
+        //    stream << uint8_t(0x00);
+        QString pin = "0";
+        auto _pin = pin.toUtf8();
+        s << uint8_t(pin.size());
+        s.writeRawData(_pin.data(), _pin.size());
+        s << uint32_t(locktime);
+        s << uint8_t(/* SIGHASH_ALL */ 1);
+    }
+
     for (i = 0; i < m_hw_inputs.size(); ++i) {
         const auto input = m_inputs.at(i).toObject();
         const auto script = ParseByteArray(input.value("prevout_script"));
 
-        startUntrustedTransaction(false, 0, {m_hw_inputs.at(i)}, {m_hw_sequences.at(i)}, script);
-
-        {
-            // untrustedLiquidHashSign
-            QByteArray data;
-            QDataStream stream(&data, QIODevice::WriteOnly);
-
-            QVector<uint32_t> user_path = ParsePath(input.value("user_path"));
-            const auto path = pathToData(user_path);
+        add(stream, header);
+        hashInput(stream, m_hw_inputs.at(i), script, m_hw_sequences.at(i));
 
-            stream.writeRawData(path.data(), data.size());
-
-            stream.setByteOrder(QDataStream::BigEndian);
-
-            // TODO android implementation uses empty pin, like:
-            //    stream << uint8_t(0x00);
-            QString pin = "0";
-            auto _pin = pin.toUtf8();
-            stream.writeRawData(path.data(), path.size());
-            stream << uint8_t(pin.size());
-            stream.writeRawData(_pin.data(), _pin.size());
-            stream << uint32_t(locktime);
-            stream << uint8_t(/* SIGHASH_ALL */ 1);
-
-            auto c = exchange(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_SIGN, 0x00, 0x00, data));
-            connect(c, &Command::finished, [this, c] {
-                QByteArray signature;
-                signature.append(0x30);
-                signature.append(c->m_response.mid(1));
-                m_sigs.append(signature);
-
-                if (m_sigs.size() == m_hw_inputs.size()) {
-                    m_abfs = m_abfs.mid(m_inputs.size());
-                    m_vbfs = m_vbfs.mid(m_inputs.size());
-                    finish();
-                }
-            });
-        }
+        // untrustedLiquidHashSign
+        const auto path = pathToData(ParsePath(input.value("user_path")));
+        add(stream, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_SIGN, 0x00, 0x00, path + sign_suffix), [this](const QByteArray& response) {
+            QByteArray signature;
+            signature.append(0x30);
+            signature.append(response.mid(1));
+            m_sigs.append(signature);
+        });
     }
+
+    run(stream, [this] {
+        Q_ASSERT(m_sigs.size() == m_hw_inputs.size());
+        m_abfs = m_abfs.mid(m_inputs.size());
+        m_vbfs = m_vbfs.mid(m_inputs.size());
+        finish();
+    });
 }
@@ -2,9 +2,7 @@
 #define LEDGERSIGNLIQUIDTRANSACTIONACTIVITY_H
 
 #include "device.h"
-
-QT_FORWARD_DECLARE_CLASS(CommandBatch);
-QT_FORWARD_DECLARE_CLASS(LedgerDevice);
+#include "ledgerdevice.h"
 
 class LedgerSignLiquidTransactionActivity : public SignLiquidTransactionActivity
 {
@@ -19,9 +17,7 @@ public:
     virtual QList<QByteArray> amountBlinders() const override { return m_vbfs; }
 
     void exec() override;
-    void getLiquidCommitment(int output_index);
 
-    DeviceCommand* exchange(const QByteArray& data);
     LedgerDevice* const m_device;
     QJsonObject m_transaction;
     QList<quint64> m_values;
@@ -40,13 +36,15 @@ public:
 
     QList<QPair<QJsonObject, QByteArray>> m_output_liquid_bytes;
 
-    int count{0};
-    void startUntrustedTransaction(bool new_transaction, int input_index, const QList<QByteArray> &inputs, const QList<QByteArray> &sequences, const QByteArray &redeem_script);
+    void add(LedgerApduStream* stream, const QByteArray& apdu, const LedgerApduStream::ResponseHandler& handler = nullptr);
+    void run(LedgerApduStream* stream, const std::function<void()>& done);
+    void startUntrustedTransaction(LedgerApduStream* stream, bool new_transaction, int input_index, const QList<QByteArray> &inputs, const QList<QByteArray> &sequences, const QByteArray &redeem_script);
+    void hashInput(LedgerApduStream* stream, const QByteArray& input, const QByteArray& script, const QByteArray& sequence);
+    void getLiquidCommitments(LedgerApduStream* stream, int output_index);
     void finalizeLiquidInputFull();
     QList<QPair<QJsonObject, QByteArray>> outputLiquidBytes();
     int exchange_count{0};
     int exchange_total{0};
-    CommandBatch* m_batch;
 };
 
 #endif // LEDGERSIGNLIQUIDTRANSACTIONACTIVITY_H
@@ -28,13 +28,9 @@ void LedgerSignMessageActivity::prepare()
     for (auto p : m_path) s << uint32_t(p);
     s << uint8_t(0) << uint8_t(m_message.size());
     s.writeRawData(m_message.toLocal8Bit().constData(), m_message.size());
-    auto command = m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_SIGN_MESSAGE, 0x00, 0x01, data));
-    connect(command, &Command::finished, this, [this, command] {
-        command->deleteLater();
+    m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_SIGN_MESSAGE, 0x00, 0x01, data), this, [this](const QByteArray&) {
         sign();
-    });
-    connect(command, &Command::error, this, [this, command] {
-        command->deleteLater();
+    }, [this] {
         fail();
     });
 }
@@ -44,15 +40,11 @@ void LedgerSignMessageActivity::sign()
     QByteArray data;
     QDataStream s(&data, QIODevice::WriteOnly);
     s << uint8_t(1) << uint8_t(0);
-    auto command = m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_SIGN_MESSAGE, 0x80, 0x01, data));
-    connect(command, &Command::finished, this, [this, command] {
-        command->deleteLater();
-        m_signature = command->m_response;
+    m_device->exchange(apdu(BTCHIP_CLA, BTCHIP_INS_SIGN_MESSAGE, 0x80, 0x01, data), this, [this](const QByteArray& response) {
+        m_signature = response;
         m_signature[0] = 0x30;
         finish();
-    });
-    connect(command, &Command::error, this, [this, command] {
-        command->deleteLater();
+    }, [this] {
         fail();
     });
 }
@@ -26,11 +26,14 @@ QList<QByteArray> LedgerSignTransactionActivity::signerCommitments() const
     Q_UNREACHABLE();
 }
 
-DeviceCommand *LedgerSignTransactionActivity::exchange(CommandBatch* batch, const QByteArray& data)
+void LedgerSignTransactionActivity::run(LedgerApduStream* stream, const std::function<void()>& done)
 {
-    auto command = new LedgerGenericCommand(m_device, data);
-    batch->add(command);
-    return command;
+    stream->then(this, [done](const QByteArray&) {
+        done();
+    }, [this] {
+        fail();
+    });
+    stream->exec();
 }
 
 void LedgerSignTransactionActivity::exec()
@@ -41,21 +44,9 @@ void LedgerSignTransactionActivity::exec()
     // Hardware Wallet cannot sign sweep inputs
     Q_ASSERT(!m_signing_address_types.contains("p2pkh"));
 
-    auto batch = new CommandBatch;
-
-    if (sw) batch->add(signSW());
-    if (p2sh) batch->add(signNonSW());
-
-    connect(batch, &CommandBatch::finished, [this, batch] {
-        batch->deleteLater();
-        emit finished();
-    });
-    connect(batch, &CommandBatch::error, [this, batch] {
-        batch->deleteLater();
-        emit fail();
-    });
-
-    batch->exec();
+    if (p2sh) return signNonSW();
+    if (sw) return signSW();
+    finish();
 }
 
 QByteArray LedgerSignTransactionActivity::outputBytes()
@@ -75,9 +66,8 @@ QByteArray LedgerSignTransactionActivity::outputBytes()
     return data;
 }
 
-Command* LedgerSignTransactionActivity::finalizeInputFull(const QByteArray &data)
+void LedgerSignTransactionActivity::finalizeInputFull(LedgerApduStream* stream, const QByteArray &data)
 {
-    auto batch = new CommandBatch;
     QList<QByteArray> datas;
     QByteArray x;
     x.append(uint8_t(0));
@@ -91,47 +81,44 @@ Command* LedgerSignTransactionActivity::finalizeInputFull(const QByteArray &data
 
     for (int i = 0; i < datas.size(); ++i) {
         uint8_t p1 = i == 0 ? 0xff : (i == datas.size() - 1 ? 0x80 : 0x00);
-        exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_FINALIZE_FULL, p1, 0x00, datas.at(i)));
+        stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_FINALIZE_FULL, p1, 0x00, datas.at(i)));
     }
-    return batch;
 }
 
-Command* LedgerSignTransactionActivity::untrustedHashSign(const QVector<uint32_t> &private_key_path, QString pin, uint32_t locktime)
+void LedgerSignTransactionActivity::untrustedHashSign(LedgerApduStream* stream, const QVector<uint32_t> &private_key_path, QString pin, uint32_t locktime)
 {
     const uint8_t sig_hash_type = 1;
-    auto batch = new CommandBatch;
 
     auto path = pathToData(private_key_path);
     auto _pin = pin.toUtf8();
     QByteArray data;
-    QDataStream stream(&data, QIODevice::WriteOnly);
-    stream.writeRawData(path.data(), path.size());
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << uint8_t(pin.size());
-    stream.writeRawData(_pin.data(), _pin.size());
-    stream << locktime << sig_hash_type;
-    auto cmd = exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_SIGN, 0, 0, data));
-    connect(cmd, &Command::finished, [this, cmd] {
+    QDataStream s(&data, QIODevice::WriteOnly);
+    s.writeRawData(path.data(), path.size());
+    s.setByteOrder(QDataStream::BigEndian);
+    s << uint8_t(pin.size());
+    s.writeRawData(_pin.data(), _pin.size());
+    s << locktime << sig_hash_type;
+    stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_SIGN, 0, 0, data), [this](const QByteArray& response) {
         QByteArray signature;
         signature.append(0x30);
-        signature.append(cmd->m_response.mid(1));
+        signature.append(response.mid(1));
         m_signatures.append(signature);
     });
-    return batch;
 }
 
-Command* LedgerSignTransactionActivity::signSW()
+void LedgerSignTransactionActivity::signSW()
 {
-    auto batch = new CommandBatch;
-    auto cmd = getHwInputs(true);
-    connect(cmd, &Command::finished, [this, batch] {
+    auto stream = new LedgerApduStream(m_device);
+    getHwInputs(stream, true);
+    run(stream, [this] {
         // Prepare the pseudo transaction
         // Provide the first script instead of a null script to initialize the P2SH confirmation logic
         const uint32_t version = m_transaction.value("transaction_version").toDouble();
         const uint32_t locktime = m_transaction.value("transaction_locktime").toDouble();
         const auto script0 = ParseByteArray(m_signing_inputs[0].toObject().value("prevout_script"));
-        batch->add(startUntrustedTransaction(version, true, 0, m_hw_inputs, script0, true));
-        batch->add(finalizeInputFull(outputBytes()));
+        auto stream = new LedgerApduStream(m_device);
+        startUntrustedTransaction(stream, version, true, 0, m_hw_inputs, script0, true);
+        finalizeInputFull(stream, outputBytes());
 
         for (int i = 0; i < m_hw_inputs.size(); i++) {
             const auto input = m_signing_inputs[i].toObject();
@@ -140,15 +127,17 @@ Command* LedgerSignTransactionActivity::signSW()
             const auto script = ParseByteArray(input.value("prevout_script"));
             const auto user_path = ParsePath(input.value("user_path"));
 
-            batch->add(startUntrustedTransaction(version, false, 0, m_hw_inputs.mid(i, 1), script, true));
-            batch->add(untrustedHashSign(user_path, "0", locktime));
+            startUntrustedTransaction(stream, version, false, 0, m_hw_inputs.mid(i, 1), script, true);
+            untrustedHashSign(stream, user_path, "0", locktime);
         }
+
+        run(stream, [this] {
+            finish();
+        });
     });
-    batch->add(cmd);
-    return batch;
 }
 
-Command* LedgerSignTransactionActivity::signNonSW()
+void LedgerSignTransactionActivity::signNonSW()
 {
     Q_UNREACHABLE();
 }
@@ -163,13 +152,11 @@ QByteArray sequenceBytes(const QJsonObject& in)
     return data;
 }
 
-Command* LedgerSignTransactionActivity::getHwInputs(bool segwit)
+void LedgerSignTransactionActivity::getHwInputs(LedgerApduStream* stream, bool segwit)
 {
     const bool shouldUseTrustedInputForSegwit = true;
     const bool prefer_trusted_inputs = !segwit || shouldUseTrustedInputForSegwit;
 
-    auto batch = new CommandBatch;
-
     if (prefer_trusted_inputs) {
         for (const auto i : m_signing_inputs) {
             const auto input = i.toObject();
@@ -178,109 +165,100 @@ Command* LedgerSignTransactionActivity::getHwInputs(bool segwit)
             uint32_t sequence = input.value("sequence").toDouble();
             Q_ASSERT(m_signing_transactions.contains(txhash));
             const auto raw = ParseByteArray(m_signing_transactions.value(txhash));
-            batch->add(getTrustedInput(raw, index, sequence, segwit));
+            getTrustedInput(stream, raw, index, sequence, segwit);
         }
     } else {
         Q_UNREACHABLE();
     }
-
-    return batch;
 }
 
-Command* LedgerSignTransactionActivity::getTrustedInput(const QByteArray& raw, uint32_t index, uint32_t sequence, bool segwit)
+void LedgerSignTransactionActivity::getTrustedInput(LedgerApduStream* stream, const QByteArray& raw, uint32_t index, uint32_t sequence, bool segwit)
 {
-    auto batch = new CommandBatch;
-
     wally_tx* tx;
     wally_tx_from_bytes((const unsigned char*) raw.constData(), raw.size(), WALLY_TX_FLAG_USE_WITNESS, &tx);
 
     {
         QByteArray data;
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream.setByteOrder(QDataStream::BigEndian);
-        stream << index;
-        stream.setByteOrder(QDataStream::LittleEndian);
-        stream << tx->version;
-        stream << varint<uint32_t>(tx->num_inputs);
-        exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x00, 0x00, data));
+        QDataStream s(&data, QIODevice::WriteOnly);
+        s.setByteOrder(QDataStream::BigEndian);
+        s << index;
+        s.setByteOrder(QDataStream::LittleEndian);
+        s << tx->version;
+        s << varint<uint32_t>(tx->num_inputs);
+        stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x00, 0x00, data));
     }
     for (size_t i = 0; i < tx->num_inputs; ++i) {
         const auto input = tx->inputs + i;
         {
             QByteArray data;
-            QDataStream stream(&data, QIODevice::WriteOnly);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream.writeRawData((const char*) input->txhash, 32);
-            stream << input->index;
-            stream << varint<uint32_t>(input->script_len);
-            exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
+            QDataStream s(&data, QIODevice::WriteOnly);
+            s.setByteOrder(QDataStream::LittleEndian);
+            s.writeRawData((const char*) input->txhash, 32);
+            s << input->index;
+            s << varint<uint32_t>(input->script_len);
+            stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
         }
         {
             QByteArray data;
-            QDataStream stream(&data, QIODevice::WriteOnly);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream.writeRawData((const char*) input->script, input->script_len);
-            stream << input->sequence;
-            exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
+            QDataStream s(&data, QIODevice::WriteOnly);
+            s.setByteOrder(QDataStream::LittleEndian);
+            s.writeRawData((const char*) input->script, input->script_len);
+            s << input->sequence;
+            stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
         }
     }
     {
         QByteArray data;
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream << varint<uint32_t>(tx->num_outputs);
-        exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
+        QDataStream s(&data, QIODevice::WriteOnly);
+        s << varint<uint32_t>(tx->num_outputs);
+        stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
     }
     for (size_t i = 0; i < tx->num_outputs; ++i) {
         const auto output = tx->outputs + i;
         {
             QByteArray data;
-            QDataStream stream(&data, QIODevice::WriteOnly);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream << quint64(output->satoshi) << varint<uint32_t>(output->script_len);
-            exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
+            QDataStream s(&data, QIODevice::WriteOnly);
+            s.setByteOrder(QDataStream::LittleEndian);
+            s << quint64(output->satoshi) << varint<uint32_t>(output->script_len);
+            stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
         }
         {
             const auto data = QByteArray((const char*) output->script, output->script_len);
-            exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
+            stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
         }
     }
 
     {
         QByteArray data;
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream.setByteOrder(QDataStream::LittleEndian);
-        stream << tx->locktime;
+        QDataStream s(&data, QIODevice::WriteOnly);
+        s.setByteOrder(QDataStream::LittleEndian);
+        s << tx->locktime;
 
-        auto cmd = exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data));
-        connect(cmd, &Command::finished, [this, cmd, sequence, segwit] {
+        stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_GET_TRUSTED_INPUT, 0x80, 0x00, data), [this, sequence, segwit](const QByteArray& response) {
             Input input;
-            input.value = cmd->m_response;
+            input.value = response;
             input.segwit = segwit;
             input.trusted = true;
 
-            QDataStream stream(&input.sequence, QIODevice::WriteOnly);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream << sequence;
+            QDataStream s(&input.sequence, QIODevice::WriteOnly);
+            s.setByteOrder(QDataStream::LittleEndian);
+            s << sequence;
 
             m_hw_inputs.append(input);
         });
     }
 
     wally_tx_free(tx);
-
-    return batch;
 }
 
-Command* LedgerSignTransactionActivity::startUntrustedTransaction(uint32_t version, bool new_transaction, size_t index, const QList<Input>& used_inputs, const QByteArray& redeem_script, bool segwit)
+void LedgerSignTransactionActivity::startUntrustedTransaction(LedgerApduStream* stream, uint32_t version, bool new_transaction, size_t index, const QList<Input>& used_inputs, const QByteArray& redeem_script, bool segwit)
 {
-    auto batch = new CommandBatch;
-
     {
         QByteArray data;
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream.setByteOrder(QDataStream::LittleEndian);
-        stream << version << varint<uint32_t>(used_inputs.size());
-        exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x00, new_transaction ? (segwit ? 0x02 : 0x00) : 0x80, data));
+        QDataStream s(&data, QIODevice::WriteOnly);
+        s.setByteOrder(QDataStream::LittleEndian);
+        s << version << varint<uint32_t>(used_inputs.size());
+        stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x00, new_transaction ? (segwit ? 0x02 : 0x00) : 0x80, data));
     }
 
     size_t current_index = 0;
@@ -288,18 +266,17 @@ Command* LedgerSignTransactionActivity::startUntrustedTransaction(uint32_t versi
         const auto script = (current_index == index ? redeem_script : QByteArray());
         {
             QByteArray data;
-            QDataStream stream(&data, QIODevice::WriteOnly);
-            stream << uint8_t(input.trusted ? 0x01 : (input.segwit ? 0x02 : 0x00));
-            if (input.trusted) stream << uint8_t(input.value.size());
-            stream.writeRawData(input.value.data(), input.value.size());
-            stream << varint<uint32_t>(script.size());
-            exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x80, 0x00, data));
+            QDataStream s(&data, QIODevice::WriteOnly);
+            s << uint8_t(input.trusted ? 0x01 : (input.segwit ? 0x02 : 0x00));
+            if (input.trusted) s << uint8_t(input.value.size());
+            s.writeRawData(input.value.data(), input.value.size());
+            s << varint<uint32_t>(script.size());
+            stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x80, 0x00, data));
         }
         {
             const auto data = script + input.sequence;
-            exchange(batch, apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x80, 0x00, data));
+            stream->add(apdu(BTCHIP_CLA, BTCHIP_INS_HASH_INPUT_START, 0x80, 0x00, data));
         }
         current_index++;
     }
-    return batch;
 }
@@ -1,9 +1,8 @@
 #ifndef GREEN_LEDGERSIGNTRANSACTIONACTIVITY_H
 #define GREEN_LEDGERSIGNTRANSACTIONACTIVITY_H
 
-#include "command.h"
 #include "device.h"
-
+#include "ledgerdevice.h"
 
 struct Input {
     QByteArray value;
@@ -19,18 +18,18 @@ public:
     QList<QByteArray> signatures() const override;
     QList<QByteArray> signerCommitments() const override;
     void exec() override;
-    Command *startUntrustedTransaction(uint32_t version, bool new_transaction, size_t index, const QList<Input> &used_inputs, const QByteArray &redeem_script, bool segwit);
-    Command *untrustedHashSign(const QVector<uint32_t> &private_key_path, QString pin, uint32_t locktime);
+    void startUntrustedTransaction(LedgerApduStream* stream, uint32_t version, bool new_transaction, size_t index, const QList<Input> &used_inputs, const QByteArray &redeem_script, bool segwit);
+    void untrustedHashSign(LedgerApduStream* stream, const QVector<uint32_t> &private_key_path, QString pin, uint32_t locktime);
 private:
-    DeviceCommand* exchange(CommandBatch *batch, const QByteArray& data);
-    Command* signSW();
-    Command* signNonSW();
+    void run(LedgerApduStream* stream, const std::function<void()>& done);
+    void signSW();
+    void signNonSW();
 
     QByteArray outputBytes();
 
-    Command* getHwInputs(bool segwit);
-    Command* finalizeInputFull(const QByteArray &data);
-    Command* getTrustedInput(const QByteArray &raw, uint32_t index, uint32_t sequence, bool segwit);
+    void getHwInputs(LedgerApduStream* stream, bool segwit);
+    void finalizeInputFull(LedgerApduStream* stream, const QByteArray &data);
+    void getTrustedInput(LedgerApduStream* stream, const QByteArray &raw, uint32_t index, uint32_t sequence, bool segwit);
 
     LedgerDevice* const m_device;
     const QJsonObject m_transaction;
@@ -14,7 +14,11 @@
 #include "clipboard.h"
 #include "devicemanager.h"
 #include "networkmanager.h"
+#include "portfoliomodel.h"
+#include "qrcodeprovider.h"
+#include "sessionprewarmer.h"
 #include "settings.h"
+#include "tracer.h"
 #include "walletmanager.h"
 #include "kdsingleapplication.h"
 #include "util.h"
@@ -117,6 +121,8 @@ int main(int argc, char *argv[])
     g_args.addOption(QCommandLineOption("debugfocus"));
     g_args.addOption(QCommandLineOption("debugjade"));
     g_args.addOption(QCommandLineOption("debugnavigation"));
+    g_args.addOption(QCommandLineOption("debugtrace"));
+    g_args.addOption(QCommandLineOption("tracefile", "", "path"));
     g_args.addOption(QCommandLineOption("channel", "", "name", "latest"));
     g_args.process(app);
 
@@ -186,11 +192,14 @@ int main(int argc, char *argv[])
     QQuickStyle::setStyle("Material");
 
     WalletManager wallet_manager;
+    SessionPrewarmer session_prewarmer;
 
     qmlRegisterSingletonInstance<Clipboard>("Blockstream.Green.Core", 0, 1, "Clipboard", Clipboard::instance());
     qmlRegisterSingletonInstance<DeviceManager>("Blockstream.Green.Core", 0, 1, "DeviceManager", DeviceManager::instance());
     qmlRegisterSingletonInstance<NetworkManager>("Blockstream.Green.Core", 0, 1, "NetworkManager", NetworkManager::instance());
+    qmlRegisterSingletonInstance<PortfolioModel>("Blockstream.Green.Core", 0, 1, "Portfolio", PortfolioModel::instance());
     qmlRegisterSingletonInstance<Settings>("Blockstream.Green.Core", 0, 1, "Settings", Settings::instance());
+    qmlRegisterSingletonInstance<Tracer>("Blockstream.Green.Core", 0, 1, "Tracer", Tracer::instance());
     qmlRegisterSingletonInstance<WalletManager>("Blockstream.Green.Core", 0, 1, "WalletManager", WalletManager::instance());
 
     QQmlApplicationEngine engine;
@@ -226,6 +235,7 @@ int main(int argc, char *argv[])
 
     QZXing::registerQMLTypes();
     QZXing::registerQMLImageProvider(engine);
+    engine.addImageProvider("qrcode", new QRCodeProvider);
 
     engine.load(QUrl(QStringLiteral("main.qml")));
     if (engine.rootObjects().isEmpty())
@@ -235,6 +245,11 @@ int main(int argc, char *argv[])
     if (ret != 0) return ret;
     ret = app.exec();
     hid_exit();
+
+    qInfo() << "trace counters:" << Tracer::instance()->counters();
+    if (g_args.isSet("tracefile")) {
+        Tracer::instance()->exportChromeTrace(g_args.value("tracefile"));
+    }
     return ret;
 }
 
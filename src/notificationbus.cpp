@@ -0,0 +1,98 @@
+#include "notificationbus.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QPointer>
+
+NotificationBus::NotificationBus(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void NotificationBus::post(const QJsonObject& notification)
+{
+    const auto event = notification.value("event").toString();
+    Q_ASSERT(!event.isEmpty());
+    const auto data = notification.value(event).toObject();
+
+    if (event == "block") {
+        BlockEvent block;
+        block.height = data.value("block_height").toDouble();
+        block.hash = data.value("block_hash").toString();
+        block.data = data;
+        enqueue(Block, [this, block] { emit blockEvent(block); });
+    } else if (event == "transaction") {
+        TransactionEvent transaction;
+        transaction.txhash = data.value("txhash").toString();
+        for (const auto pointer : data.value("subaccounts").toArray()) {
+            transaction.subaccounts.append(pointer.toInt());
+        }
+        transaction.data = data;
+        enqueue(Transaction, [this, transaction] { emit transactionEvent(transaction); });
+    } else if (event == "settings") {
+        enqueue(Settings, [this, data] { emit settingsEvent(data); });
+    } else if (event == "network" || event == "session") {
+        NetworkEvent network;
+        network.connected = data.value("connected").toBool();
+        network.loginRequired = data.value("login_required").toBool();
+        network.data = data;
+        if (event == "network") {
+            enqueue(Network, [this, network] { emit networkEvent(network); });
+        } else {
+            enqueue(Session, [this, network] { emit sessionEvent(network); });
+        }
+    } else if (event == "tor") {
+        TorEvent tor;
+        tor.progress = data.value("progress").toInt();
+        tor.summary = data.value("summary").toString();
+        tor.tag = data.value("tag").toString();
+        tor.data = data;
+        enqueue(Tor, [this, tor] { emit torEvent(tor); });
+    } else if (event == "twofactor_reset") {
+        TwoFactorResetEvent reset;
+        reset.active = data.value("is_active").toBool();
+        reset.data = data;
+        enqueue(TwoFactorReset, [this, reset] { emit twoFactorResetEvent(reset); });
+    } else {
+        qDebug() << "unhandled notification" << event;
+    }
+}
+
+void NotificationBus::enqueue(Topic topic, std::function<void()>&& dispatch)
+{
+    QMutexLocker locker(&m_mutex);
+    const bool schedule = m_pending.isEmpty();
+    m_pending.append({ topic, std::move(dispatch) });
+    if (schedule) QMetaObject::invokeMethod(this, &NotificationBus::flush, Qt::QueuedConnection);
+}
+
+void NotificationBus::flush()
+{
+    QVector<Entry> pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        pending.swap(m_pending);
+    }
+
+    // Only the last block event of the batch is relevant, subscribers
+    // resync from the chain tip anyway.
+    int last_block = -1;
+    for (int i = pending.size() - 1; i >= 0; --i) {
+        if (pending.at(i).topic == Block) {
+            last_block = i;
+            break;
+        }
+    }
+
+    // A subscriber can tear down the session while handling an event.
+    QPointer<NotificationBus> self(this);
+    for (int i = 0; i < pending.size() && self; ++i) {
+        const auto& entry = pending.at(i);
+        if (entry.topic == Block && i != last_block) {
+            m_coalesced++;
+            continue;
+        }
+        entry.dispatch();
+    }
+}
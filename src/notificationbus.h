@@ -0,0 +1,88 @@
+#ifndef GREEN_NOTIFICATIONBUS_H
+#define GREEN_NOTIFICATIONBUS_H
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+
+#include <functional>
+
+struct BlockEvent
+{
+    quint32 height{0};
+    QString hash;
+    QJsonObject data;
+};
+
+struct TransactionEvent
+{
+    QString txhash;
+    QVector<int> subaccounts;
+    QJsonObject data;
+};
+
+struct NetworkEvent
+{
+    bool connected{false};
+    bool loginRequired{false};
+    QJsonObject data;
+};
+
+struct TorEvent
+{
+    int progress{0};
+    QString summary;
+    QString tag;
+    QJsonObject data;
+};
+
+struct TwoFactorResetEvent
+{
+    bool active{false};
+    QJsonObject data;
+};
+
+// Parses GDK notifications once, on the thread that posts them, and delivers
+// them on the bus thread through one signal per topic so that subscribers only
+// see the events they connect to. Events posted while a flush is pending are
+// batched, and only the most recent block event of a batch is delivered.
+class NotificationBus : public QObject
+{
+    Q_OBJECT
+public:
+    enum Topic {
+        Block,
+        Transaction,
+        Settings,
+        Network,
+        Session,
+        Tor,
+        TwoFactorReset,
+    };
+
+    NotificationBus(QObject* parent = nullptr);
+    // Thread safe.
+    void post(const QJsonObject& notification);
+    int coalesced() const { return m_coalesced; }
+signals:
+    void blockEvent(const BlockEvent& event);
+    void transactionEvent(const TransactionEvent& event);
+    void settingsEvent(const QJsonObject& settings);
+    void networkEvent(const NetworkEvent& event);
+    void sessionEvent(const NetworkEvent& event);
+    void torEvent(const TorEvent& event);
+    void twoFactorResetEvent(const TwoFactorResetEvent& event);
+private:
+    struct Entry {
+        Topic topic;
+        std::function<void()> dispatch;
+    };
+    void enqueue(Topic topic, std::function<void()>&& dispatch);
+    void flush();
+    QMutex m_mutex;
+    QVector<Entry> m_pending;
+    int m_coalesced{0};
+};
+
+#endif // GREEN_NOTIFICATIONBUS_H
@@ -36,11 +36,10 @@ void Output::update()
     setLocked(m_data["user_status"].toInt() == 1);
     setConfidential(m_data["confidential"].toBool());
     setUnconfirmed(m_data["block_height"].toDouble() == 0);
-    setAddressType(m_data["address_type"].toString());
-    if (m_address_type == "csv") {
-        auto block_height = m_data["block_height"].toDouble() + m_data["subtype"].toDouble();
-        auto current_block_height = m_account->wallet()->events()["block"].toObject()["block_height"].toDouble();
-        setExpired(block_height < current_block_height);
+    setAddressType(Intern(m_data["address_type"].toString()));
+    if (m_address_type == QLatin1String("csv")) {
+        const quint32 expiry_height = m_data["block_height"].toDouble() + m_data["subtype"].toDouble();
+        setExpired(expiry_height < m_account->wallet()->blockHeight());
     } else {
         setExpired(m_data["nlocktime_at"].toInt() == 0);
     }
@@ -1,4 +1,6 @@
 #include "account.h"
+#include "activityscheduler.h"
+#include "confirmationtracker.h"
 #include "resolver.h"
 #include "output.h"
 #include "outputlistmodel.h"
@@ -19,36 +21,35 @@ void OutputListModel::setAccount(Account *account)
 {
     if (!m_account.update(account)) return;
     beginResetModel();
-    m_get_outputs_activity.update(nullptr);
+    // Detached before cancelling so that its handlers don't run.
+    if (auto activity = m_get_outputs_activity.get()) {
+        m_get_outputs_activity.update(nullptr);
+        activity->cancel();
+        activity->deleteLater();
+    }
     m_outputs.clear();
     endResetModel();
     emit accountChanged(m_account);
     fetch();
     if (m_account) {
-        m_account.track(QObject::connect(m_account, &Account::notificationHandled, this, [this](const QJsonObject& notification) {
-            const auto event = notification.value("event").toString();
-            if (event == "transaction") {
-                // In Wallet::handleNotification transaction notifications are only
-                // forward to relevant accounts meaning that it's fine to always
-                // update there.
-                fetch();
-            } else if (event == "block") {
-                bool has_unconfirmed = false;
-                for (auto& output : m_outputs) {
-                    if (output->unconfirmed()) {
-                        has_unconfirmed = true;
-                        break;
-                    }
-                }
-                if (has_unconfirmed) {
-                    // Need to fetch coins since unconfirmed coins can now be included in the block.
-                    fetch();
-                } else {
-                    // Just update existing coins.
-                    update();
+        // In Wallet transaction events are only forwarded to relevant
+        // accounts meaning that it's fine to always update there.
+        m_account.track(QObject::connect(m_account, &Account::transactionEvent, this, &OutputListModel::fetch));
+        m_account.track(QObject::connect(m_account, &Account::blockEvent, this, [this] {
+            bool has_unconfirmed = false;
+            for (auto& output : m_outputs) {
+                if (output->unconfirmed()) {
+                    has_unconfirmed = true;
+                    break;
                 }
             }
+            if (has_unconfirmed) {
+                // Need to fetch coins since unconfirmed coins can now be included in the block.
+                fetch();
+            }
         }));
+        // Expired coins are updated by the confirmation tracker.
+        m_account.track(QObject::connect(m_account->confirmationTracker(), &ConfirmationTracker::outputsChanged, this, &OutputListModel::handleOutputsChanged));
     }
 }
 
@@ -68,15 +69,26 @@ void OutputListModel::fetch()
         m_get_outputs_activity.update(nullptr);
         emit fetchingChanged();
     }));
+    // Failed or cancelled, for instance on logout, the next fetch retries.
+    const auto abandon = [this] {
+        m_get_outputs_activity->deleteLater();
+        m_get_outputs_activity.update(nullptr);
+        emit fetchingChanged();
+    };
+    m_get_outputs_activity.track(QObject::connect(m_get_outputs_activity, &Activity::failed, this, abandon));
+    m_get_outputs_activity.track(QObject::connect(m_get_outputs_activity, &Activity::cancelled, this, abandon));
 
-    m_get_outputs_activity->exec();
+    m_account->wallet()->scheduler()->schedule(m_get_outputs_activity);
     emit fetchingChanged();
 }
 
-void OutputListModel::update()
+void OutputListModel::handleOutputsChanged(const QVector<Output*>& outputs)
 {
-    for (auto& output : m_outputs) {
-        output->update();
+    for (auto output : outputs) {
+        const int row = m_outputs.indexOf(output);
+        if (row < 0) continue;
+        const auto index = this->index(row);
+        emit dataChanged(index, index, { Qt::UserRole });
     }
 }
 
@@ -32,7 +32,7 @@ signals:
     void fetchingChanged();
     void selectionChanged();
 private:
-    void update();
+    void handleOutputsChanged(const QVector<Output*>& outputs);
 private:
     Connectable<Account> m_account;
     QVector<Output*> m_outputs;
@@ -24,8 +24,8 @@ bool OutputListModelFilter::filterAcceptsRow(int source_row, const QModelIndex &
         bool invert = filter.startsWith('!');
         if (invert) filter = filter.mid(1);
         bool result = true;
-        if (filter == "csv") result = output->addressType() == "csv";
-        if (filter == "p2wsh") result = output->addressType() == "p2wsh";
+        if (filter == "csv") result = output->addressType() == QLatin1String("csv");
+        if (filter == "p2wsh") result = output->addressType() == QLatin1String("p2wsh");
         if (filter == "dust") result = output->dust();
         if (filter == "locked") result = output->locked();
         if (filter == "not confidential") result = !output->confidential();
@@ -0,0 +1,225 @@
+#include "asset.h"
+#include "network.h"
+#include "portfoliomodel.h"
+#include "wallet.h"
+#include "walletmanager.h"
+
+#include <QLocale>
+
+namespace {
+    bool IsPolicyAsset(Network* network, const QString& asset_id)
+    {
+        return asset_id == (network->isLiquid() ? network->policyAsset() : QStringLiteral("btc"));
+    }
+} // namespace
+
+PortfolioModel::PortfolioModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+    auto manager = WalletManager::instance();
+    for (auto wallet : manager->m_wallets) {
+        addWallet(wallet);
+    }
+    connect(manager, &WalletManager::walletAdded, this, &PortfolioModel::addWallet);
+    connect(manager, &WalletManager::aboutToRemove, this, &PortfolioModel::removeWallet);
+}
+
+PortfolioModel* PortfolioModel::instance()
+{
+    static PortfolioModel instance;
+    return &instance;
+}
+
+void PortfolioModel::addWallet(Wallet* wallet)
+{
+    connect(wallet, &Wallet::authenticationChanged, this, [this, wallet] { update(wallet); });
+    connect(wallet, &Wallet::totalsChanged, this, [this, wallet] {
+        if (wallet->isAuthenticated()) apply(wallet, wallet->totals());
+    });
+    connect(wallet, &Wallet::settingsChanged, this, [this, wallet] { updateRate(wallet); });
+    update(wallet);
+}
+
+void PortfolioModel::removeWallet(Wallet* wallet)
+{
+    disconnect(wallet, nullptr, this, nullptr);
+    apply(wallet, {});
+    if (m_rates.remove(wallet) > 0) notifyRate(wallet->network());
+}
+
+void PortfolioModel::update(Wallet* wallet)
+{
+    apply(wallet, wallet->isAuthenticated() ? wallet->totals() : QHash<QString, qint64>());
+    updateRate(wallet);
+}
+
+void PortfolioModel::apply(Wallet* wallet, const QHash<QString, qint64>& totals)
+{
+    auto previous = m_contributions.take(wallet);
+    const bool previous_empty = previous.isEmpty();
+    QHash<QString, qint64> contribution;
+    for (auto i = totals.constBegin(); i != totals.constEnd(); ++i) {
+        if (i.value() == 0) continue;
+        contribution.insert(i.key(), i.value());
+        updateRow(wallet->network(), i.key(), previous.take(i.key()), i.value());
+    }
+    for (auto i = previous.constBegin(); i != previous.constEnd(); ++i) {
+        updateRow(wallet->network(), i.key(), i.value(), 0);
+    }
+    if (!contribution.isEmpty()) m_contributions.insert(wallet, contribution);
+    // The wallet joined or left the contributors whose currencies must agree.
+    if (previous_empty != contribution.isEmpty()) notifyRate(wallet->network());
+}
+
+void PortfolioModel::updateRow(Network* network, const QString& asset_id, qint64 from, qint64 to)
+{
+    if (from == to) return;
+    const auto key = qMakePair(network, asset_id);
+    int row = m_row_by_key.value(key, -1);
+    if (row < 0) {
+        row = m_rows.size();
+        beginInsertRows(QModelIndex(), row, row);
+        m_rows.append({ network, asset_id, 0, 0 });
+        m_row_by_key.insert(key, row);
+        endInsertRows();
+    }
+    auto& r = m_rows[row];
+    r.amount += to - from;
+    if (from == 0) ++r.wallets;
+    if (to == 0) --r.wallets;
+    if (r.wallets > 0) {
+        emit dataChanged(index(row), index(row), { AmountRole, WalletCountRole, FiatRole });
+    } else {
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rows.remove(row);
+        m_row_by_key.remove(key);
+        for (int i = row; i < m_rows.size(); ++i) {
+            m_row_by_key.insert(qMakePair(m_rows.at(i).network, m_rows.at(i).asset_id), i);
+        }
+        endRemoveRows();
+    }
+    if (IsPolicyAsset(network, asset_id)) emit fiatChanged();
+}
+
+void PortfolioModel::updateRate(Wallet* wallet)
+{
+    const bool had_rate = m_rates.remove(wallet) > 0;
+    if (wallet->isAuthenticated() && wallet->session()) {
+        const auto result = wallet->convert({{ "satoshi", 100000000 }});
+        bool ok;
+        const double value = QLocale::c().toDouble(result.value("fiat").toString().replace(',', '.'), &ok);
+        if (ok) m_rates.insert(wallet, { value, result.value("fiat_currency").toString() });
+    }
+    if (!had_rate && !m_rates.contains(wallet)) return;
+    notifyRate(wallet->network());
+}
+
+void PortfolioModel::notifyRate(Network* network)
+{
+    for (int row = 0; row < m_rows.size(); ++row) {
+        if (m_rows.at(row).network == network && IsPolicyAsset(network, m_rows.at(row).asset_id)) {
+            emit dataChanged(index(row), index(row), { FiatRole });
+        }
+    }
+    emit fiatChanged();
+}
+
+const PortfolioModel::Rate* PortfolioModel::rate(Network* network) const
+{
+    const Rate* rate = nullptr;
+    for (auto i = m_contributions.constBegin(); i != m_contributions.constEnd(); ++i) {
+        if (i.key()->network() != network) continue;
+        auto wallet_rate = m_rates.constFind(i.key());
+        if (wallet_rate == m_rates.constEnd()) return nullptr;
+        if (!rate) rate = &wallet_rate.value();
+        if (wallet_rate->currency != rate->currency) return nullptr;
+    }
+    return rate;
+}
+
+QVariant PortfolioModel::fiat(const Row& row) const
+{
+    if (!IsPolicyAsset(row.network, row.asset_id)) return {};
+    auto rate = this->rate(row.network);
+    if (!rate) return {};
+    return row.amount * rate->value / 100000000;
+}
+
+double PortfolioModel::fiatTotal() const
+{
+    if (fiatCurrency().isEmpty()) return -1;
+    double total = 0;
+    for (const auto& row : m_rows) {
+        if (!IsPolicyAsset(row.network, row.asset_id)) continue;
+        const auto value = fiat(row);
+        if (!value.isValid()) return -1;
+        total += value.toDouble();
+    }
+    return total;
+}
+
+QString PortfolioModel::fiatCurrency() const
+{
+    QString currency;
+    for (const auto& row : m_rows) {
+        if (!IsPolicyAsset(row.network, row.asset_id)) continue;
+        auto rate = this->rate(row.network);
+        if (!rate) return {};
+        if (currency.isEmpty()) currency = rate->currency;
+        if (rate->currency != currency) return {};
+    }
+    return currency;
+}
+
+QHash<int, QByteArray> PortfolioModel::roleNames() const
+{
+    return {
+        { NetworkRole, "network" },
+        { AssetIdRole, "asset_id" },
+        { AssetRole, "asset" },
+        { NameRole, "name" },
+        { AmountRole, "amount" },
+        { WalletCountRole, "wallet_count" },
+        { FiatRole, "fiat" }
+    };
+}
+
+int PortfolioModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return m_rows.size();
+}
+
+QVariant PortfolioModel::data(const QModelIndex& index, int role) const
+{
+    const auto& row = m_rows.at(index.row());
+    Asset* asset = nullptr;
+    if ((role == AssetRole || role == NameRole) && row.network->isLiquid()) {
+        // Any contributing wallet has the asset, registry data included.
+        for (auto i = m_contributions.constBegin(); i != m_contributions.constEnd(); ++i) {
+            if (i.key()->network() == row.network && i.value().contains(row.asset_id)) {
+                asset = i.key()->getOrCreateAsset(row.asset_id);
+                break;
+            }
+        }
+    }
+    switch (role)
+    {
+        case NetworkRole:
+            return QVariant::fromValue(row.network);
+        case AssetIdRole:
+            return row.asset_id;
+        case AssetRole:
+            return QVariant::fromValue(asset);
+        case NameRole:
+            return asset ? asset->name() : row.network->name();
+        case AmountRole:
+            return row.amount;
+        case WalletCountRole:
+            return row.wallets;
+        case FiatRole:
+            return fiat(row);
+    }
+
+    return QVariant();
+}
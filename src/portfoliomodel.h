@@ -0,0 +1,78 @@
+#ifndef GREEN_PORTFOLIOMODEL_H
+#define GREEN_PORTFOLIOMODEL_H
+
+#include <QtQml>
+#include <QAbstractListModel>
+#include <QHash>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(Network)
+QT_FORWARD_DECLARE_CLASS(Wallet)
+
+// Totals per network and asset across all authenticated wallets. Each wallet
+// contributes its own per asset totals, and only the difference to its last
+// contribution is applied when they change. Each wallet's rate is queried from
+// GDK in its own pricing currency when it authenticates or its pricing
+// changes, and a network has a fiat value only while its contributing
+// wallets agree on the currency, so rows never convert amounts themselves.
+class PortfolioModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(double fiatTotal READ fiatTotal NOTIFY fiatChanged)
+    Q_PROPERTY(QString fiatCurrency READ fiatCurrency NOTIFY fiatChanged)
+public:
+    enum Role {
+        NetworkRole = Qt::UserRole,
+        AssetIdRole,
+        AssetRole,
+        NameRole,
+        AmountRole,
+        WalletCountRole,
+        FiatRole,
+    };
+
+    static PortfolioModel* instance();
+
+    // Negative when a rate is missing or the wallets price in different
+    // currencies.
+    double fiatTotal() const;
+    QString fiatCurrency() const;
+
+    QHash<int, QByteArray> roleNames() const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+signals:
+    void fiatChanged();
+private:
+    PortfolioModel(QObject* parent = nullptr);
+    struct Row {
+        Network* network;
+        QString asset_id;
+        qint64 amount;
+        int wallets;
+    };
+    struct Rate {
+        double value;
+        QString currency;
+    };
+    void addWallet(Wallet* wallet);
+    void removeWallet(Wallet* wallet);
+    void update(Wallet* wallet);
+    void apply(Wallet* wallet, const QHash<QString, qint64>& totals);
+    void updateRow(Network* network, const QString& asset_id, qint64 from, qint64 to);
+    void updateRate(Wallet* wallet);
+    void notifyRate(Network* network);
+    // Rate of the contributing wallets of the network, null if any is
+    // missing or they price in different currencies.
+    const Rate* rate(Network* network) const;
+    QVariant fiat(const Row& row) const;
+
+    QVector<Row> m_rows;
+    QHash<QPair<Network*, QString>, int> m_row_by_key;
+    // Non zero totals of each authenticated wallet as last applied.
+    QHash<Wallet*, QHash<QString, qint64>> m_contributions;
+    // Rate of each authenticated wallet in its pricing currency.
+    QHash<Wallet*, Rate> m_rates;
+};
+
+#endif // GREEN_PORTFOLIOMODEL_H
@@ -0,0 +1,97 @@
+#include "qrcodeprovider.h"
+
+#include <QRunnable>
+#include <QUrl>
+
+#include <QZXing.h>
+
+#include <atomic>
+
+namespace {
+    const QSize DEFAULT_SIZE{240, 240};
+    // Cost is in pixels, about 64 receive screen sized codes.
+    const int CACHE_COST = 64 * 240 * 240;
+
+    QString CacheKey(const QString& payload, const QSize& size)
+    {
+        return QString("%1x%2:%3").arg(size.width()).arg(size.height()).arg(payload);
+    }
+
+    class QRCodeResponse : public QQuickImageResponse, public QRunnable
+    {
+    public:
+        QRCodeResponse(QRCodeProvider* provider, const QString& payload, const QSize& size)
+            : m_provider(provider)
+            , m_payload(payload)
+            , m_size(size)
+        {
+            setAutoDelete(false);
+        }
+        explicit QRCodeResponse(const QImage& image)
+            : m_provider(nullptr)
+            , m_image(image)
+        {
+            setAutoDelete(false);
+            QMetaObject::invokeMethod(this, [this] { emit finished(); }, Qt::QueuedConnection);
+        }
+        QQuickTextureFactory* textureFactory() const override
+        {
+            return QQuickTextureFactory::textureFactoryForImage(m_image);
+        }
+        void cancel() override
+        {
+            m_cancelled = true;
+        }
+        void run() override
+        {
+            // Superseded while queued, the engine still expects finished.
+            if (!m_cancelled) m_image = m_provider->encode(m_payload, m_size);
+            emit finished();
+        }
+    private:
+        QRCodeProvider* const m_provider;
+        const QString m_payload;
+        const QSize m_size;
+        QImage m_image;
+        std::atomic<bool> m_cancelled{false};
+    };
+} // namespace
+
+QRCodeProvider::QRCodeProvider()
+    : m_cache(CACHE_COST)
+{
+    // Only the latest payload matters, more threads wouldn't help.
+    m_pool.setMaxThreadCount(1);
+}
+
+QQuickImageResponse* QRCodeProvider::requestImageResponse(const QString& id, const QSize& requested_size)
+{
+    const auto payload = QUrl::fromPercentEncoding(id.toUtf8());
+    const auto size = requested_size.isValid() ? requested_size : DEFAULT_SIZE;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (auto image = m_cache.object(CacheKey(payload, size))) {
+            return new QRCodeResponse(*image);
+        }
+    }
+    auto response = new QRCodeResponse(this, payload, size);
+    m_pool.start(response);
+    return response;
+}
+
+QImage QRCodeProvider::encode(const QString& payload, const QSize& size)
+{
+    if (payload.isEmpty()) return {};
+    const auto key = CacheKey(payload, size);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (auto image = m_cache.object(key)) return *image;
+    }
+
+    const auto image = QZXing::encodeData(payload, QZXing::EncoderFormat_QR_CODE, size,
+                                          QZXing::EncodeErrorCorrectionLevel_L, /* border = */ true, /* transparent = */ true);
+
+    QMutexLocker locker(&m_mutex);
+    m_cache.insert(key, new QImage(image), size.width() * size.height());
+    return image;
+}
@@ -0,0 +1,26 @@
+#ifndef GREEN_QRCODEPROVIDER_H
+#define GREEN_QRCODEPROVIDER_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QQuickAsyncImageProvider>
+#include <QThreadPool>
+
+// Encodes QR codes for image://qrcode/<payload> on a worker thread, so that
+// payloads changing while typing never block the GUI thread. Images are kept
+// in an LRU cache keyed by payload and size, edits that return to a previous
+// payload are served without encoding.
+class QRCodeProvider : public QQuickAsyncImageProvider
+{
+public:
+    QRCodeProvider();
+    QQuickImageResponse* requestImageResponse(const QString& id, const QSize& requested_size) override;
+    QImage encode(const QString& payload, const QSize& size);
+private:
+    QMutex m_mutex;
+    QCache<QString, QImage> m_cache;
+    QThreadPool m_pool;
+};
+
+#endif // GREEN_QRCODEPROVIDER_H
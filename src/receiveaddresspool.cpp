@@ -0,0 +1,101 @@
+#include "account.h"
+#include "handler.h"
+#include "json.h"
+#include "network.h"
+#include "receiveaddresspool.h"
+#include "resolver.h"
+#include "wallet.h"
+
+#include <gdk.h>
+
+class GetReceiveAddressHandler : public Handler
+{
+    Account* const m_account;
+    void call(GA_session* session, GA_auth_handler** auth_handler) override
+    {
+        auto address_details = Json::fromObject({
+            { "subaccount", static_cast<qint64>(m_account->pointer()) },
+        });
+
+        int err = GA_get_receive_address(session, address_details.get(), auth_handler);
+        Q_ASSERT(err == GA_OK);
+    }
+public:
+    GetReceiveAddressHandler(Account* account)
+        : Handler(account->wallet())
+        , m_account(account)
+    {
+    }
+};
+
+ReceiveAddressPool::ReceiveAddressPool(Account* account)
+    : QObject(account)
+    , m_account(account)
+    // Pooled addresses are dropped on logout but stay issued. Singlesig
+    // wallets only scan 20 unused addresses ahead, leaving some behind each
+    // session could hide later deposits, so those only generate on demand.
+    , m_capacity(account->wallet()->network()->isElectrum() ? 0 : 5)
+{
+    connect(account->wallet(), &Wallet::authenticationChanged, this, [this] {
+        if (!m_account->wallet()->isAuthenticated()) clear();
+    });
+}
+
+ReceiveAddressPool::~ReceiveAddressPool()
+{
+}
+
+QJsonObject ReceiveAddressPool::take()
+{
+    const auto address = m_addresses.isEmpty() ? QJsonObject() : m_addresses.dequeue();
+    refill();
+    return address;
+}
+
+void ReceiveAddressPool::refill(bool urgent)
+{
+    if (m_handler) {
+        // Someone is now waiting for the address being generated.
+        if (urgent) m_handler->setBackground(false);
+        return;
+    }
+    if (m_addresses.size() >= qMax(m_capacity, urgent ? 1 : 0)) return;
+    auto wallet = m_account->wallet();
+    if (!wallet->isAuthenticated() || wallet->isLocked()) return;
+
+    auto handler = new GetReceiveAddressHandler(m_account);
+    handler->setBackground(!urgent);
+    m_handler.update(handler);
+    m_handler.track(connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
+        m_handler.update(nullptr);
+        m_addresses.enqueue(handler->result().value("result").toObject());
+        emit available();
+        refill();
+    }));
+    m_handler.track(connect(handler, &Handler::error, this, [this, handler] {
+        handler->deleteLater();
+        m_handler.update(nullptr);
+        // Not retried, a device may have rejected it.
+        emit failed();
+    }));
+    m_handler.track(connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
+        resolver->resolve();
+    }));
+    handler->exec();
+}
+
+void ReceiveAddressPool::clear()
+{
+    if (auto handler = m_handler.get()) {
+        // Can't be deleted while running, released once it completes and
+        // its address is discarded.
+        m_handler.update(nullptr);
+        connect(handler, &Handler::done, handler, &QObject::deleteLater);
+        connect(handler, &Handler::error, handler, &QObject::deleteLater);
+        connect(handler, &Handler::resolver, handler, [](Resolver* resolver) {
+            resolver->resolve();
+        });
+    }
+    m_addresses.clear();
+}
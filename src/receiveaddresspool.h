@@ -0,0 +1,43 @@
+#ifndef GREEN_RECEIVEADDRESSPOOL_H
+#define GREEN_RECEIVEADDRESSPOOL_H
+
+#include "connectable.h"
+
+#include <QJsonObject>
+#include <QObject>
+#include <QQueue>
+
+QT_FORWARD_DECLARE_CLASS(Account)
+QT_FORWARD_DECLARE_CLASS(Handler)
+
+// Receive addresses of an account generated ahead of use, including device
+// round trips such as blinding on Liquid, so that they are handed out
+// without waiting. Addresses are taken in the order GDK issued them and the
+// pool is refilled on the background thread. GDK already counts pooled
+// addresses as issued, so they are dropped when the session goes away.
+// Singlesig accounts keep no addresses ahead, see the constructor.
+class ReceiveAddressPool : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ReceiveAddressPool(Account* account);
+    virtual ~ReceiveAddressPool();
+    bool isEmpty() const { return m_addresses.isEmpty(); }
+    // Returns the next address, empty if none is ready, and refills.
+    QJsonObject take();
+    // Starts generating unless the pool is full or already generating, at
+    // interactive priority when someone is waiting for an address, in which
+    // case one address is generated even if the pool keeps none ahead.
+    void refill(bool urgent = false);
+signals:
+    void available();
+    void failed();
+private:
+    void clear();
+    Account* const m_account;
+    const int m_capacity;
+    QQueue<QJsonObject> m_addresses;
+    Connectable<Handler> m_handler;
+};
+
+#endif // GREEN_RECEIVEADDRESSPOOL_H
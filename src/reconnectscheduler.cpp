@@ -0,0 +1,59 @@
+#include "network.h"
+#include "reconnectscheduler.h"
+
+#include <QDebug>
+#include <QMap>
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+namespace {
+    const int MIN_DELAY = 1000;
+    const int MAX_DELAY = 60000;
+} // namespace
+
+ReconnectScheduler* ReconnectScheduler::instance(Network* network)
+{
+    Q_ASSERT(network);
+    static QMap<Network*, ReconnectScheduler*> schedulers;
+    auto scheduler = schedulers.value(network);
+    if (!scheduler) {
+        scheduler = new ReconnectScheduler(network);
+        schedulers.insert(network, scheduler);
+    }
+    return scheduler;
+}
+
+ReconnectScheduler::ReconnectScheduler(Network* network)
+    : QObject(network)
+    , m_network(network)
+{
+}
+
+int ReconnectScheduler::nextDelay() const
+{
+    if (m_failures == 0) return 0;
+    const int shift = std::min(m_failures - 1, 6);
+    const int ceiling = std::min(MIN_DELAY << shift, MAX_DELAY);
+    // Equal jitter, wait at least half of the ceiling.
+    return ceiling / 2 + QRandomGenerator::global()->bounded(ceiling / 2 + 1);
+}
+
+void ReconnectScheduler::reportFailure()
+{
+    // Sessions failing together count as one failure.
+    if (m_last_failure.isValid() && m_last_failure.elapsed() < MIN_DELAY) return;
+    m_last_failure.start();
+    m_failures ++;
+    qDebug() << "reconnect" << m_network->id() << "failures" << m_failures;
+}
+
+void ReconnectScheduler::reportSuccess()
+{
+    if (m_failures == 0) return;
+    qDebug() << "reconnect" << m_network->id() << "reachable";
+    // The network is back, previous failures say nothing about the others.
+    m_failures = 0;
+    m_last_failure.invalidate();
+    emit reachable();
+}
@@ -0,0 +1,35 @@
+#ifndef GREEN_RECONNECTSCHEDULER_H
+#define GREEN_RECONNECTSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+
+QT_FORWARD_DECLARE_CLASS(Network)
+
+// Connection attempts of all sessions on the same network share one backoff
+// state: failures double the delay up to a cap and any success resets it.
+// Delays are jittered so that sessions don't retry in lockstep. Reachability
+// comes from GDK itself, when a session connects or GDK reports a session
+// connected after failures, reachable() is emitted so the others retry
+// without waiting for their backoff.
+class ReconnectScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    static ReconnectScheduler* instance(Network* network);
+
+    int failures() const { return m_failures; }
+    // Delay in milliseconds for the next attempt of a session.
+    int nextDelay() const;
+    void reportFailure();
+    void reportSuccess();
+signals:
+    void reachable();
+private:
+    explicit ReconnectScheduler(Network* network);
+    Network* const m_network;
+    int m_failures{0};
+    QElapsedTimer m_last_failure;
+};
+
+#endif // GREEN_RECONNECTSCHEDULER_H
@@ -107,7 +107,7 @@ void GetXPubsResolver::resolve()
         activity->deleteLater();
         setFailed(true);
     });
-    activity->exec();
+    device()->schedule(activity, wallet());
 }
 
 SignTransactionResolver::SignTransactionResolver(Handler* handler, const QJsonObject& result)
@@ -148,7 +148,7 @@ void SignTransactionResolver::resolve()
         activity->deleteLater();
         m_handler->fail();
     });
-    activity->exec();
+    device()->schedule(activity, wallet());
 }
 
 BlindingKeysResolver::BlindingKeysResolver(Handler* handler, const QJsonObject& result)
@@ -185,7 +185,7 @@ void BlindingKeysResolver::resolve()
         activity->deleteLater();
         m_handler->error();
     });
-    activity->exec();
+    device()->schedule(activity, wallet());
 }
 
 BlindingKeyResolver::BlindingKeyResolver(Handler* handler, const QJsonObject& result)
@@ -207,7 +207,7 @@ void BlindingKeyResolver::resolve()
         activity->deleteLater();
         m_handler->error();
     });
-    activity->exec();
+    device()->schedule(activity, wallet());
 }
 
 
@@ -239,7 +239,7 @@ void BlindingNoncesResolver::resolve()
         activity->deleteLater();
         m_handler->error();
     });
-    activity->exec();
+    device()->schedule(activity, wallet());
 }
 
 SignLiquidTransactionResolver::SignLiquidTransactionResolver(Handler* handler, const QJsonObject& result)
@@ -330,6 +330,6 @@ void SignLiquidTransactionResolver::resolve()
     connect(activity, &Activity::failed, [this] {
         setFailed(true);
     });
-    activity->exec();
+    device()->schedule(activity, wallet());
     pushActivity(activity);
 }
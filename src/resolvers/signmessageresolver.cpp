@@ -2,6 +2,7 @@
 #include "handler.h"
 #include "signmessageresolver.h"
 #include "util.h"
+#include "wallet.h"
 
 SignMessageResolver::SignMessageResolver(Handler* handler, const QJsonObject& result)
     : DeviceResolver(handler, result)
@@ -30,5 +31,5 @@ void SignMessageResolver::resolve()
         activity->deleteLater();
         setFailed(true);
     });
-    activity->exec();
+    device()->schedule(activity, wallet());
 }
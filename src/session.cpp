@@ -1,6 +1,8 @@
 #include "handlers/connecthandler.h"
 #include "json.h"
 #include "network.h"
+#include "notificationbus.h"
+#include "reconnectscheduler.h"
 #include "session.h"
 #include "settings.h"
 
@@ -8,7 +10,21 @@
 
 Session::Session(QObject* parent)
     : Entity(parent)
+    , m_bus(new NotificationBus(this))
+    , m_connect_timer(new QTimer(this))
 {
+    m_connect_timer->setSingleShot(true);
+    connect(m_connect_timer, &QTimer::timeout, this, [this] {
+        if (m_connect_handler) m_connect_handler->exec();
+    });
+    connect(m_bus, &NotificationBus::sessionEvent, this, [this](const NetworkEvent& event) {
+        setConnected(event.connected);
+    });
+    connect(m_bus, &NotificationBus::networkEvent, this, [this](const NetworkEvent& event) {
+        setConnected(event.connected);
+        // GDK reconnected on its own, sessions still backing off can retry.
+        if (event.connected && m_network) ReconnectScheduler::instance(m_network)->reportSuccess();
+    });
 }
 
 Session::~Session()
@@ -16,34 +32,6 @@ Session::~Session()
     setActive(false);
 }
 
-void Session::handleNotification(const QJsonObject& notification)
-{
-    emit notificationHandled(notification);
-
-    const auto event = notification.value("event").toString();
-    Q_ASSERT(!event.isEmpty());
-    const auto value = notification.value(event);
-
-    if (event == "session") {
-        auto data = value.toObject();
-        emit sessionEvent(data);
-        const bool connected = data.value("connected").toBool();
-        setConnected(connected);
-        return;
-    }
-    if (event == "network") {
-        auto data = value.toObject();
-        emit networkEvent(data);
-        const bool connected = data.value("connected").toBool();
-        setConnected(connected);
-        return;
-    }
-    if (event == "tor") {
-        emit torEvent(value.toObject());
-        return;
-    }
-}
-
 void Session::setConnected(bool connected)
 {
     if (m_connected == connected) return;
@@ -82,38 +70,39 @@ void Session::update()
         Q_ASSERT(rc == GA_OK);
 
         rc = GA_set_notification_handler(m_session, [](void* context, GA_json* details) {
-            auto session = static_cast<Session*>(context);
-            auto notification = Json::toObject(details);
+            auto bus = static_cast<NotificationBus*>(context);
+            bus->post(Json::toObject(details));
             GA_destroy_json(details);
-            QMetaObject::invokeMethod(session, [session, notification] {
-                session->handleNotification(notification);
-            }, Qt::QueuedConnection);
-        }, this);
+        }, m_bus);
         Q_ASSERT(rc == GA_OK);
 
         const bool use_tor = !m_network->isElectrum() && Settings::instance()->useTor();
         if (use_tor) emit activityCreated(new SessionTorCircuitActivity(this));
         emit activityCreated(new SessionConnectActivity(this));
+        auto scheduler = ReconnectScheduler::instance(m_network);
+        m_reachable_connection = QObject::connect(scheduler, &ReconnectScheduler::reachable, this, &Session::handleReachable);
         m_connect_handler = new ConnectHandler(this, m_network, Settings::instance()->proxy(), use_tor);
-        m_connect_handler.track(QObject::connect(m_connect_handler, &ConnectHandler::finished, [this] {
+        m_connect_handler.track(QObject::connect(m_connect_handler, &ConnectHandler::finished, [this, scheduler] {
             if (m_connect_handler->resultAt(0) == GA_OK) {
-                m_connect_handler->deleteLater();
+                auto handler = m_connect_handler.get();
+                m_connect_handler = nullptr;
+                handler->deleteLater();
                 setConnected(true);
-            } else if (m_connect_handler->attempts < 3) {
-                QTimer::singleShot(1000, this, [this] {
-                    m_connect_handler->exec();
-                });
+                // Only once connected, reachable() is also delivered here.
+                scheduler->reportSuccess();
             } else {
-                m_connect_handler->deleteLater();
-                setConnected(false);
+                scheduler->reportFailure();
+                scheduleConnect();
             }
         }));
-        m_connect_handler->exec();
+        m_connect_timer->start(scheduler->nextDelay());
 
         return;
     }
 
     if ((!m_active || !m_network) && m_session) {
+        QObject::disconnect(m_reachable_connection);
+        m_connect_timer->stop();
         m_connect_handler.destroy();
 
         GA_set_notification_handler(m_session, nullptr, nullptr);
@@ -134,6 +123,29 @@ void Session::update()
     }
 }
 
+void Session::scheduleConnect()
+{
+    const int delay = ReconnectScheduler::instance(m_network)->nextDelay();
+    qDebug() << "connect" << m_network->id() << "attempt" << m_connect_handler->attempts << "failed, retry in" << delay << "ms";
+    m_connect_timer->start(delay);
+}
+
+void Session::handleReachable()
+{
+    if (m_connect_handler) {
+        // Still connecting, skip the remaining backoff.
+        if (m_connect_handler->isRunning()) return;
+        m_connect_timer->stop();
+        m_connect_handler->exec();
+    } else if (m_session && !m_connected) {
+        // GDK reconnects established sessions on its own, hint it to not
+        // wait for its own backoff.
+        auto hint = Json::fromObject({{ "hint", "now" }});
+        const int rc = GA_reconnect_hint(m_session, hint.get());
+        if (rc != GA_OK) qDebug() << "reconnect hint failed" << rc;
+    }
+}
+
 SessionActivity::SessionActivity(Session* session)
     : Activity(session)
     , m_session(session)
@@ -143,24 +155,21 @@ SessionActivity::SessionActivity(Session* session)
 SessionTorCircuitActivity::SessionTorCircuitActivity(Session* session)
     : SessionActivity(session)
 {
-    m_tor_event_connection = connect(session, &Session::torEvent, this, [this](const QJsonObject& event) {
-        const int progress_value = event.value("progress").toInt();
-        if (progress_value > 0) {
+    m_tor_event_connection = connect(session->bus(), &NotificationBus::torEvent, this, [this](const TorEvent& event) {
+        if (event.progress > 0) {
             progress()->setIndeterminate(false);
             progress()->setTo(100);
-            progress()->setValue(progress_value);
+            progress()->setValue(event.progress);
         }
 
-        const auto summary = event.value("summary").toString();
-        if (!summary.isEmpty()) {
-            m_logs.prepend(summary);
+        if (!event.summary.isEmpty()) {
+            m_logs.prepend(event.summary);
             emit logsChanged(m_logs);
         }
 
         // TODO: handle errors
 
-        const auto tag = event.value("tag").toString();
-        if (tag == "done") {
+        if (event.tag == "done") {
             finish();
             QObject::disconnect(m_tor_event_connection);
             QObject::disconnect(m_connected_connection);
@@ -11,6 +11,7 @@
 QT_FORWARD_DECLARE_CLASS(Connection);
 QT_FORWARD_DECLARE_CLASS(ConnectHandler);
 QT_FORWARD_DECLARE_CLASS(Network);
+QT_FORWARD_DECLARE_CLASS(NotificationBus);
 
 QT_FORWARD_DECLARE_STRUCT(GA_session)
 
@@ -31,26 +32,27 @@ public:
     void setActive(bool active);
     bool isConnected() const { return m_connected; }
     Connection* connection() const { return m_connection; };
+    NotificationBus* bus() const { return m_bus; }
 signals:
     void networkChanged(Network* network);
-    void notificationHandled(const QJsonObject& notification);
-    void networkEvent(const QJsonObject& event);
-    void sessionEvent(const QJsonObject& event);
     void activeChanged(bool active);
     void connectedChanged(bool connected);
-    void torEvent(const QJsonObject& event);
     void activityCreated(Activity* activity);
 private:
     void update();
-    void handleNotification(const QJsonObject& notification);
     void setConnected(bool connected);
+    void scheduleConnect();
+    void handleReachable();
 public:
+    NotificationBus* const m_bus;
     Network* m_network{nullptr};
     bool m_active{false};
     // TODO: make m_session private
     GA_session* m_session{nullptr};
     bool m_connected{false};
     Connectable<ConnectHandler> m_connect_handler;
+    QTimer* const m_connect_timer;
+    QMetaObject::Connection m_reachable_connection;
     Connection* m_connection{nullptr};
 };
 
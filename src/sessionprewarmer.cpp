@@ -0,0 +1,82 @@
+#include "session.h"
+#include "sessionprewarmer.h"
+#include "settings.h"
+#include "wallet.h"
+#include "walletmanager.h"
+
+#include <QDebug>
+#include <QTimer>
+
+SessionPrewarmer::SessionPrewarmer(QObject* parent)
+    : QObject(parent)
+{
+    if (!Settings::instance()->prewarmSessions()) return;
+    for (const auto& id : Settings::instance()->recentWallets()) {
+        auto wallet = WalletManager::instance()->wallet(id);
+        if (wallet) prewarm(wallet);
+    }
+    qInfo() << "prewarming" << m_entries.size() << "sessions";
+}
+
+SessionPrewarmer::~SessionPrewarmer()
+{
+    if (m_entries.isEmpty()) return;
+    qint64 connect_time = 0;
+    int connected = 0;
+    for (const auto& entry : m_entries) {
+        if (entry.connect_time < 0) continue;
+        connect_time += entry.connect_time;
+        connected ++;
+    }
+    qInfo() << "prewarm summary:" << m_entries.size() << "sessions," << connected << "connected in" << connect_time << "ms total,"
+            << m_hits << "hits," << m_misses << "misses," << (m_entries.size() - m_hits - m_misses) << "unused";
+}
+
+void SessionPrewarmer::prewarm(Wallet* wallet)
+{
+    // Hardware and watch only wallets connect on their own flows.
+    if (wallet->device() || !wallet->hasPinData() || wallet->session()) return;
+
+    wallet->createSession();
+    auto session = wallet->session();
+    auto& entry = m_entries[wallet];
+    entry.timer.start();
+
+    connect(session, &Session::connectedChanged, this, [this, wallet](bool connected) {
+        if (!connected) return;
+        auto& entry = m_entries[wallet];
+        if (entry.connect_time >= 0) return;
+        entry.connect_time = entry.timer.elapsed();
+        entry.connecting = true;
+        QTimer::singleShot(0, this, [this, wallet] {
+            if (m_entries.contains(wallet)) m_entries[wallet].connecting = false;
+        });
+        qInfo() << "prewarm" << wallet->id() << "connected in" << entry.connect_time << "ms";
+    });
+    connect(wallet, &Wallet::authenticationChanged, this, [this, wallet] {
+        handleAuthenticationChanged(wallet);
+    });
+    connect(wallet, &QObject::destroyed, this, [this, wallet] {
+        m_entries.remove(wallet);
+    });
+
+    session->setActive(true);
+}
+
+void SessionPrewarmer::handleAuthenticationChanged(Wallet* wallet)
+{
+    if (wallet->authentication() != Wallet::Authenticating) return;
+    auto& entry = m_entries[wallet];
+    if (entry.used) return;
+    entry.used = true;
+
+    // A hit means login went straight to authentication, otherwise the
+    // login had to wait for the prewarmed session to connect.
+    if (entry.connect_time >= 0 && !entry.connecting) {
+        m_hits ++;
+        qInfo() << "prewarm hit" << wallet->id() << "connected" << (entry.timer.elapsed() - entry.connect_time) << "ms before login";
+    } else {
+        m_misses ++;
+        qInfo() << "prewarm miss" << wallet->id();
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef GREEN_SESSIONPREWARMER_H
+#define GREEN_SESSIONPREWARMER_H
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+
+QT_FORWARD_DECLARE_CLASS(Wallet)
+
+// When enabled in settings, connects the sessions of the recently used wallets
+// at startup, bootstrapping Tor if required, so that logging in only has to
+// authenticate. Connect times and whether logins found a connected session
+// are logged.
+class SessionPrewarmer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SessionPrewarmer(QObject* parent = nullptr);
+    virtual ~SessionPrewarmer();
+private:
+    struct Entry {
+        QElapsedTimer timer;
+        qint64 connect_time{-1};
+        // Set while the connected signal is being delivered, a login that
+        // authenticates meanwhile was waiting for the connection.
+        bool connecting{false};
+        bool used{false};
+    };
+    void prewarm(Wallet* wallet);
+    void handleAuthenticationChanged(Wallet* wallet);
+    QMap<Wallet*, Entry> m_entries;
+    int m_hits{0};
+    int m_misses{0};
+};
+
+#endif // GREEN_SESSIONPREWARMER_H
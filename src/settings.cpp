@@ -102,6 +102,14 @@ void Settings::setUseTor(bool use_tor)
     saveLater();
 }
 
+void Settings::setPrewarmSessions(bool prewarm_sessions)
+{
+    if (m_prewarm_sessions == prewarm_sessions) return;
+    m_prewarm_sessions = prewarm_sessions;
+    emit prewarmSessionsChanged(m_prewarm_sessions);
+    saveLater();
+}
+
 void Settings::setCheckForUpdates(bool check_for_updates)
 {
     if (m_check_for_updates == check_for_updates) return;
@@ -185,6 +193,7 @@ void Settings::load(const QSettings& settings)
     LOAD(m_proxy_host)
     LOAD(m_proxy_port)
     LOAD(m_use_tor)
+    LOAD(m_prewarm_sessions)
     LOAD(m_recent_wallets)
     LOAD(m_language)
     LOAD(m_check_for_updates)
@@ -213,6 +222,7 @@ void Settings::saveNow()
     SAVE(m_proxy_host)
     SAVE(m_proxy_port)
     SAVE(m_use_tor)
+    SAVE(m_prewarm_sessions)
     SAVE(m_recent_wallets)
     SAVE(m_language)
     SAVE(m_check_for_updates)
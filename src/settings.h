@@ -20,6 +20,7 @@ class Settings : public QObject
     Q_PROPERTY(QString proxyHost READ proxyHost WRITE setProxyHost NOTIFY proxyHostChanged)
     Q_PROPERTY(int proxyPort READ proxyPort WRITE setProxyPort NOTIFY proxyPortChanged)
     Q_PROPERTY(bool useTor READ useTor WRITE setUseTor NOTIFY useTorChanged)
+    Q_PROPERTY(bool prewarmSessions READ prewarmSessions WRITE setPrewarmSessions NOTIFY prewarmSessionsChanged)
     Q_PROPERTY(bool checkForUpdates READ checkForUpdates WRITE setCheckForUpdates NOTIFY checkForUpdatesChanged)
     Q_PROPERTY(QStringList recentWallets READ recentWallets NOTIFY recentWalletsChanged)
     Q_PROPERTY(QString language READ language WRITE setLanguage NOTIFY languageChanged)
@@ -50,6 +51,8 @@ public:
     QString proxy() const;
     bool useTor() const { return m_use_tor; }
     void setUseTor(bool use_tor);
+    bool prewarmSessions() const { return m_prewarm_sessions; }
+    void setPrewarmSessions(bool prewarm_sessions);
     bool checkForUpdates() const { return m_check_for_updates; }
     void setCheckForUpdates(bool m_check_for_updates);
     QStringList recentWallets();
@@ -70,6 +73,7 @@ signals:
     void proxyHostChanged(const QString& proxy_host);
     void proxyPortChanged(int proxy_port);
     void useTorChanged(bool use_tor);
+    void prewarmSessionsChanged(bool prewarm_sessions);
     void recentWalletsChanged(const QStringList& recent_wallets);
     void languageChanged(const QString& language);
 private:
@@ -92,6 +96,7 @@ private:
     QString m_proxy_host{};
     int m_proxy_port{9001};
     bool m_use_tor{false};
+    bool m_prewarm_sessions{false};
     bool m_check_for_updates{true};
     QStringList m_recent_wallets;
     QString m_language;
@@ -3,14 +3,18 @@ INCLUDEPATH += $$PWD
 SOURCES += \
     $$PWD/accountcontroller.cpp \
     $$PWD/account.cpp \
+    $$PWD/activityscheduler.cpp \
     $$PWD/address.cpp \
     $$PWD/addresslistmodel.cpp \
     $$PWD/addresslistmodelfilter.cpp \
     $$PWD/appupdatecontroller.cpp \
     $$PWD/asset.cpp \
     $$PWD/balance.cpp \
+    $$PWD/bip39.cpp \
     $$PWD/clipboard.cpp \
+    $$PWD/coinselector.cpp \
     $$PWD/command.cpp \
+    $$PWD/confirmationtracker.cpp \
     $$PWD/controller.cpp \
     $$PWD/createaccountcontroller.cpp \
     $$PWD/device.cpp \
@@ -21,7 +25,9 @@ SOURCES += \
     $$PWD/devicelistmodel.cpp \
     $$PWD/devicemanager.cpp \
     $$PWD/entity.cpp \
+    $$PWD/feeestimator.cpp \
     $$PWD/ga.cpp \
+    $$PWD/hashkey.cpp \
     $$PWD/httprequestactivity.cpp \
     $$PWD/json.cpp \
     $$PWD/main.cpp \
@@ -29,16 +35,23 @@ SOURCES += \
     $$PWD/network.cpp \
     $$PWD/networkmanager.cpp \
     $$PWD/newsfeedcontroller.cpp \
+    $$PWD/notificationbus.cpp \
+    $$PWD/portfoliomodel.cpp \
+    $$PWD/qrcodeprovider.cpp \
+    $$PWD/receiveaddresspool.cpp \
+    $$PWD/reconnectscheduler.cpp \
     $$PWD/renameaccountcontroller.cpp \
     $$PWD/resolver.cpp \
     $$PWD/restorecontroller.cpp \
     $$PWD/semver.cpp \
     $$PWD/session.cpp \
+    $$PWD/sessionprewarmer.cpp \
     $$PWD/settings.cpp \
     $$PWD/signupcontroller.cpp \
     $$PWD/output.cpp \
     $$PWD/outputlistmodel.cpp \
     $$PWD/outputlistmodelfilter.cpp \
+    $$PWD/tracer.cpp \
     $$PWD/transaction.cpp \
     $$PWD/transactionlistmodel.cpp \
     $$PWD/twofactorcontroller.cpp \
@@ -46,20 +59,25 @@ SOURCES += \
     $$PWD/wallet.cpp \
     $$PWD/walletlistmodel.cpp \
     $$PWD/walletmanager.cpp \
+    $$PWD/walletstore.cpp \
     $$PWD/wally.cpp \
     $$PWD/watchonlylogincontroller.cpp
 
 HEADERS += \
     $$PWD/accountcontroller.h \
     $$PWD/account.h \
+    $$PWD/activityscheduler.h \
     $$PWD/address.h \
     $$PWD/addresslistmodel.h \
     $$PWD/addresslistmodelfilter.h \
     $$PWD/appupdatecontroller.h \
     $$PWD/asset.h \
     $$PWD/balance.h \
+    $$PWD/bip39.h \
     $$PWD/clipboard.h \
+    $$PWD/coinselector.h \
     $$PWD/command.h \
+    $$PWD/confirmationtracker.h \
     $$PWD/connectable.h \
     $$PWD/controller.h \
     $$PWD/createaccountcontroller.h \
@@ -72,23 +90,32 @@ HEADERS += \
     $$PWD/devicelistmodel.h \
     $$PWD/devicemanager.h \
     $$PWD/entity.h \
+    $$PWD/feeestimator.h \
     $$PWD/ga.h \
+    $$PWD/hashkey.h \
     $$PWD/httprequestactivity.h \
     $$PWD/json.h \
     $$PWD/navigation.h \
     $$PWD/network.h \
     $$PWD/networkmanager.h \
     $$PWD/newsfeedcontroller.h \
+    $$PWD/notificationbus.h \
+    $$PWD/portfoliomodel.h \
+    $$PWD/qrcodeprovider.h \
+    $$PWD/receiveaddresspool.h \
+    $$PWD/reconnectscheduler.h \
     $$PWD/renameaccountcontroller.h \
     $$PWD/resolver.h \
     $$PWD/restorecontroller.h \
     $$PWD/semver.h \
     $$PWD/session.h \
+    $$PWD/sessionprewarmer.h \
     $$PWD/settings.h \
     $$PWD/signupcontroller.h \
     $$PWD/output.h \
     $$PWD/outputlistmodel.h \
     $$PWD/outputlistmodelfilter.h \
+    $$PWD/tracer.h \
     $$PWD/transaction.h \
     $$PWD/transactionlistmodel.h \
     $$PWD/twofactorcontroller.h \
@@ -96,6 +123,7 @@ HEADERS += \
     $$PWD/wallet.h \
     $$PWD/walletlistmodel.h \
     $$PWD/walletmanager.h \
+    $$PWD/walletstore.h \
     $$PWD/wally.h \
     $$PWD/watchonlylogincontroller.h
 
@@ -0,0 +1,162 @@
+#include "tracer.h"
+#include "util.h"
+#include "wallet.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSaveFile>
+#include <QThread>
+
+#include <algorithm>
+
+namespace {
+    // About a minute of a busy login with a hardware wallet.
+    const int RING_CAPACITY = 32768;
+    const qint64 COUNTER_BUCKET = 1000000;
+    // An hour of rates for each counter.
+    const int COUNTER_BUCKETS = 3600;
+} // namespace
+
+Tracer::Tracer(QObject* parent)
+    : QObject(parent)
+{
+    m_events.reserve(RING_CAPACITY);
+    m_clock.start();
+}
+
+Tracer* Tracer::instance()
+{
+    static Tracer instance;
+    return &instance;
+}
+
+qint64 Tracer::now() const
+{
+    return m_clock.nsecsElapsed() / 1000;
+}
+
+void Tracer::record(Event&& event)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_events.size() < RING_CAPACITY) {
+        m_events.append(std::move(event));
+    } else {
+        m_events[m_next] = std::move(event);
+        m_wrapped = true;
+    }
+    m_next = (m_next + 1) % RING_CAPACITY;
+}
+
+void Tracer::span(const char* category, const QString& name, qint64 begin, Wallet* wallet, int account)
+{
+    const qint64 end = now();
+    record({ category, name, wallet ? wallet->id() : QString(), account, begin, end - begin, quintptr(QThread::currentThreadId()) });
+}
+
+void Tracer::count(const QString& counter, qint64 delta)
+{
+    const qint64 bucket = now() / COUNTER_BUCKET;
+    QMutexLocker locker(&m_mutex);
+    m_counters[counter] += delta;
+    auto& rates = m_rates[counter];
+    rates[bucket] += delta;
+    if (rates.size() > COUNTER_BUCKETS) rates.erase(rates.begin());
+}
+
+QHash<QString, qint64> Tracer::counters() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_counters;
+}
+
+bool Tracer::exportChromeTrace(const QString& path) const
+{
+    QVector<Event> events;
+    QHash<QString, QMap<qint64, qint64>> rates;
+    bool wrapped;
+    {
+        QMutexLocker locker(&m_mutex);
+        events = m_events;
+        rates = m_rates;
+        wrapped = m_wrapped;
+        if (wrapped) std::rotate(events.begin(), events.begin() + m_next, events.end());
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray trace_events;
+    for (const auto& event : events) {
+        QJsonObject args;
+        if (!event.wallet.isEmpty()) args.insert("wallet", event.wallet);
+        if (event.account >= 0) args.insert("account", event.account);
+        trace_events.append(QJsonObject{
+            { "name", event.name },
+            { "cat", event.category },
+            { "ph", "X" },
+            { "ts", event.begin },
+            { "dur", event.duration },
+            { "pid", pid },
+            { "tid", QString::number(event.thread) },
+            { "args", args }
+        });
+    }
+    // Counters are exported as rates.
+    for (auto i = rates.begin(); i != rates.end(); ++i) {
+        const QString name = i.key() + "/s";
+        qint64 last = -2;
+        for (auto j = i.value().begin(); j != i.value().end(); ++j) {
+            // Drop to zero across idle seconds.
+            if (j.key() > last + 1 && last >= 0) {
+                trace_events.append(QJsonObject{
+                    { "name", name }, { "ph", "C" }, { "ts", (last + 1) * COUNTER_BUCKET }, { "pid", pid }, { "args", QJsonObject{{ "value", 0 }} }
+                });
+            }
+            trace_events.append(QJsonObject{
+                { "name", name }, { "ph", "C" }, { "ts", j.key() * COUNTER_BUCKET }, { "pid", pid }, { "args", QJsonObject{{ "value", j.value() }} }
+            });
+            last = j.key();
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "failed to open trace file" << path;
+        return false;
+    }
+    file.write(QJsonDocument(QJsonObject{
+        { "traceEvents", trace_events },
+        { "displayTimeUnit", "ms" },
+        { "otherData", QJsonObject{{ "version", QCoreApplication::applicationVersion() }, { "truncated", wrapped }} }
+    }).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning() << "failed to write trace file" << path;
+        return false;
+    }
+    qInfo() << "exported" << trace_events.size() << "trace events to" << path;
+    return true;
+}
+
+QString Tracer::exportTrace() const
+{
+    const auto name = QString("trace-%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    const auto path = GetDataFile("logs", name);
+    return exportChromeTrace(path) ? path : QString();
+}
+
+TraceSpan::TraceSpan(const char* category, const QString& name, Wallet* wallet, int account)
+    : m_category(category)
+    , m_name(name)
+    , m_wallet(wallet)
+    , m_account(account)
+    , m_begin(Tracer::instance()->now())
+{
+}
+
+TraceSpan::~TraceSpan()
+{
+    Tracer::instance()->span(m_category, m_name, m_begin, m_wallet, m_account);
+}
@@ -0,0 +1,73 @@
+#ifndef GREEN_TRACER_H
+#define GREEN_TRACER_H
+
+#include <QtQml>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(Wallet)
+
+// Records spans of GDK calls, resolver steps, device APDUs and Jade RPCs in
+// a fixed size ring buffer. Counters like GDK calls and bytes over each
+// device transport are summed apart in one second buckets, so that busy
+// transports don't evict spans. Recording is thread safe and cheap enough to
+// be always on, data is only serialized when exported as a Chrome trace, see
+// chrome://tracing or https://ui.perfetto.dev.
+class Tracer : public QObject
+{
+    Q_OBJECT
+public:
+    static Tracer* instance();
+
+    // Microseconds since the tracer started, the time base of all events.
+    qint64 now() const;
+    void span(const char* category, const QString& name, qint64 begin, Wallet* wallet = nullptr, int account = -1);
+    void count(const QString& counter, qint64 delta = 1);
+    QHash<QString, qint64> counters() const;
+
+    bool exportChromeTrace(const QString& path) const;
+    // Exports to a timestamped file in the data directory, returns its path
+    // or an empty string on failure.
+    Q_INVOKABLE QString exportTrace() const;
+private:
+    Tracer(QObject* parent = nullptr);
+    struct Event {
+        const char* category;
+        QString name;
+        QString wallet;
+        int account;
+        qint64 begin;
+        qint64 duration;
+        quintptr thread;
+    };
+    void record(Event&& event);
+
+    QElapsedTimer m_clock;
+    mutable QMutex m_mutex;
+    QVector<Event> m_events;
+    int m_next{0};
+    bool m_wrapped{false};
+    QHash<QString, qint64> m_counters;
+    // Counter sums by second, the oldest seconds are dropped.
+    QHash<QString, QMap<qint64, qint64>> m_rates;
+};
+
+// Records a span from construction to destruction.
+class TraceSpan
+{
+public:
+    TraceSpan(const char* category, const QString& name, Wallet* wallet = nullptr, int account = -1);
+    ~TraceSpan();
+private:
+    const char* const m_category;
+    const QString m_name;
+    Wallet* const m_wallet;
+    const int m_account;
+    const qint64 m_begin;
+};
+
+#endif // GREEN_TRACER_H
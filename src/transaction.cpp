@@ -8,6 +8,21 @@
 #include "wallet.h"
 #include <gdk.h>
 
+#include <QCache>
+#include <QCborValue>
+
+namespace {
+    // Decoded data of recently used transactions, usually the visible rows
+    // and the one being viewed.
+    const int DATA_CACHE_SIZE = 256;
+
+    QCache<const Transaction*, QJsonObject>& DataCache()
+    {
+        static QCache<const Transaction*, QJsonObject> cache(DATA_CACHE_SIZE);
+        return cache;
+    }
+} // namespace
+
 TransactionAmount::TransactionAmount(Transaction *transaction, qint64 amount)
     : TransactionAmount(transaction, nullptr, amount)
 {
@@ -30,7 +45,7 @@ TransactionAmount::~TransactionAmount()
 
 QString TransactionAmount::formatAmount(bool include_ticker) const
 {
-    QString prefix = m_transaction->data().value("type").toString() != "incoming" ? "-" : "";
+    QString prefix = m_transaction->type() != "incoming" ? "-" : "";
     if (m_asset) {
         return prefix + m_asset->formatAmount(m_amount, include_ticker);
     } else {
@@ -47,12 +62,18 @@ Transaction::Transaction(Account* account)
 
 Transaction::~Transaction()
 {
-
+    DataCache().remove(this);
 }
 
 bool Transaction::isUnconfirmed() const
 {
-    return m_data.value("block_height").toInt(0) == 0;
+    return m_block_height == 0;
+}
+
+int Transaction::confirmations() const
+{
+    if (m_block_height == 0) return 0;
+    return 1 + int(m_account->wallet()->blockHeight()) - int(m_block_height);
 }
 
 Account *Transaction::account() const
@@ -62,64 +83,93 @@ Account *Transaction::account() const
 
 QQmlListProperty<TransactionAmount> Transaction::amounts()
 {
+    materializeAmounts();
     return { this, &m_amounts };
 }
 
+QList<TransactionAmount*> Transaction::amountList()
+{
+    materializeAmounts();
+    return m_amounts;
+}
+
+void Transaction::materializeAmounts()
+{
+    if (m_amounts.size() == m_amount_values.size()) return;
+    for (const auto& value : m_amount_values) {
+        m_amounts.append(new TransactionAmount(this, value.asset, value.amount));
+    }
+}
+
 QJsonObject Transaction::data() const
 {
-    return m_data;
+    if (m_blob.isEmpty()) return {};
+    auto& cache = DataCache();
+    auto data = cache.object(this);
+    if (data) return *data;
+    data = new QJsonObject(QCborValue::fromCbor(m_blob).toMap().toJsonObject());
+    cache.insert(this, data);
+    return *data;
 }
 
 void Transaction::updateFromData(const QJsonObject& data)
 {
-    if (m_data == data) return;
-    m_data = data;
-    emit dataChanged(m_data);
+    const auto blob = QCborValue::fromJsonValue(data).toCbor();
+    if (m_blob == blob) return;
+    m_blob = blob;
+    DataCache().insert(this, new QJsonObject(data));
+
+    m_hash = data.value("txhash").toString();
+    m_type = Intern(data.value("type").toString());
+    m_block_height = data.value("block_height").toDouble();
 
-    setMemo(m_data.value("memo").toString());
+    emit dataChanged(data);
+    emit confirmationsChanged();
 
+    setMemo(data.value("memo").toString());
+    updateAmounts(data);
+}
+
+void Transaction::updateAmounts(const QJsonObject& data)
+{
     // Amounts are one time set
-    const auto satoshi = m_data.value("satoshi").toObject();
-    const int count = satoshi.keys().length();
-
-    if (m_amounts.empty() && count > 0) {
-        qDebug() << Q_FUNC_INFO << data;
-
-        Wallet* wallet = m_account->wallet();
-        const auto satoshi = m_data.value("satoshi").toObject();
-        if (wallet->network()->isLiquid()) {
-            const auto type = data.value("type").toString();
-            if (type == "incoming" || type == "redeposit") {
-                for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
-                    Asset* asset = wallet->getOrCreateAsset(i.key());
-                    qint64 amount = i.value().toDouble();
-                    m_amounts.append(new TransactionAmount(this, asset, amount));
-                }
-            } else if (type == "outgoing") {
-                for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
-                    qint64 amount = i.value().toDouble();
-                    if (i.key() == wallet->network()->policyAsset()) {
-                        qint64 fee = data.value("fee").toDouble();
-                        Q_ASSERT(fee <= amount);
-                        amount -= fee;
-                        if (amount == 0) continue; // just fee
-                    }
-                    Asset* asset = wallet->getOrCreateAsset(i.key());
-                    m_amounts.append(new TransactionAmount(this, asset, amount));
+    if (m_amounts_set) return;
+    const auto satoshi = data.value("satoshi").toObject();
+    if (satoshi.isEmpty()) return;
+    m_amounts_set = true;
+
+    Wallet* wallet = m_account->wallet();
+    if (wallet->network()->isLiquid()) {
+        if (m_type == "incoming" || m_type == "redeposit") {
+            for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
+                Asset* asset = wallet->getOrCreateAsset(i.key());
+                qint64 amount = i.value().toDouble();
+                m_amount_values.append({ asset, amount });
+            }
+        } else if (m_type == "outgoing") {
+            for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
+                qint64 amount = i.value().toDouble();
+                if (i.key() == wallet->network()->policyAsset()) {
+                    qint64 fee = data.value("fee").toDouble();
+                    Q_ASSERT(fee <= amount);
+                    amount -= fee;
+                    if (amount == 0) continue; // just fee
                 }
+                Asset* asset = wallet->getOrCreateAsset(i.key());
+                m_amount_values.append({ asset, amount });
             }
-        } else {
-            qint64 amount = satoshi.value("btc").toDouble();
-            m_amounts.append(new TransactionAmount(this, amount));
         }
-
-        emit amountsChanged();
+    } else {
+        qint64 amount = satoshi.value("btc").toDouble();
+        m_amount_values.append({ nullptr, amount });
     }
+
+    emit amountsChanged();
 }
 
 void Transaction::openInExplorer() const
 {
-    m_account->wallet()->network()->openTransactionInExplorer(m_data.value("txhash").toString());
+    m_account->wallet()->network()->openTransactionInExplorer(m_hash);
 }
 
 QString Transaction::unblindedLink() const
@@ -128,8 +178,9 @@ QString Transaction::unblindedLink() const
 
     auto tx_explorer_url = m_account->wallet()->network()->explorerUrl();
 
-    const auto inputs = m_data.value("inputs").toArray();
-    const auto outputs = m_data.value("outputs").toArray();
+    const auto data = this->data();
+    const auto inputs = data.value("inputs").toArray();
+    const auto outputs = data.value("outputs").toArray();
 
     QStringList args;
 
@@ -149,14 +200,14 @@ QString Transaction::unblindedLink() const
     for (const auto &v : inputs) append_blinding_data(v);
     for (const auto &v : outputs) append_blinding_data(v);
 
-    return QString("%1%2#blinded=%3").arg(tx_explorer_url, m_data.value("txhash").toString(), args.join(','));
+    return QString("%1%2#blinded=%3").arg(tx_explorer_url, m_hash, args.join(','));
 }
 
 void Transaction::updateMemo(const QString& memo)
 {
     Q_ASSERT(memo.length() <= 1024);
     if (m_memo == memo) return;
-    auto txhash = m_data.value("txhash").toString().toLocal8Bit();
+    auto txhash = m_hash.toLocal8Bit();
     int err = GA_set_transaction_memo(m_account->wallet()->m_session->m_session, txhash.constData(), memo.toLocal8Bit().constData(), 0);
     Q_ASSERT(err == GA_OK);
     setMemo(memo);
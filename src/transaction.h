@@ -43,21 +43,27 @@ class Transaction : public QObject
     Q_PROPERTY(QQmlListProperty<TransactionAmount> amounts READ amounts NOTIFY amountsChanged)
     Q_PROPERTY(QJsonObject data READ data NOTIFY dataChanged)
     Q_PROPERTY(QString memo READ memo NOTIFY memoChanged)
+    Q_PROPERTY(int confirmations READ confirmations NOTIFY confirmationsChanged)
     QML_ELEMENT
     QML_UNCREATABLE("Transaction is instanced by Wallet.")
 public:
     explicit Transaction(Account* account);
     virtual ~Transaction();
 
-    QString hash() const { return m_data.value("txhash").toString(); }
+    QString hash() const { return m_hash; }
+    QString type() const { return m_type; }
     QString memo() const { return m_memo; }
+    quint32 blockHeight() const { return m_block_height; }
 
     bool isUnconfirmed() const;
+    int confirmations() const;
 
     Account* account() const;
 
     QQmlListProperty<TransactionAmount> amounts();
+    QList<TransactionAmount*> amountList();
 
+    // Decoded from the compact record, recently used ones are cached.
     QJsonObject data() const;
 
     void updateFromData(const QJsonObject& data);
@@ -71,13 +77,30 @@ signals:
     void amountsChanged();
     void dataChanged(const QJsonObject& data);
     void memoChanged(const QString& memo);
+    void confirmationsChanged();
 private:
     void setMemo(const QString& memo);
+    void updateAmounts(const QJsonObject& data);
+    void materializeAmounts();
 public:
     Account* const m_account;
-    QList<TransactionAmount*> m_amounts;
-    QJsonObject m_data;
+    // Compact record of the GDK transaction, the few fields used when
+    // listing are kept decoded and the whole data, including inputs and
+    // outputs, is kept as CBOR.
+    QString m_hash;
+    QString m_type;
+    quint32 m_block_height{0};
+    QByteArray m_blob;
     QString m_memo;
+    // Amounts by asset, the asset is null on bitcoin. TransactionAmount
+    // objects are only created when amounts are first accessed.
+    struct Amount {
+        Asset* asset;
+        qint64 amount;
+    };
+    QVector<Amount> m_amount_values;
+    QList<TransactionAmount*> m_amounts;
+    bool m_amounts_set{false};
 };
 
 #endif // GREEN_TRANSACTION_H
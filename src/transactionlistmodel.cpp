@@ -1,9 +1,12 @@
 #include "account.h"
+#include "activityscheduler.h"
+#include "confirmationtracker.h"
 #include "resolver.h"
 #include "transaction.h"
 #include "transactionlistmodel.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 
 TransactionListModel::TransactionListModel(QObject* parent)
     : QAbstractListModel(parent)
@@ -13,8 +16,7 @@ TransactionListModel::TransactionListModel(QObject* parent)
     m_reload_timer->setInterval(200);
     connect(m_reload_timer, &QTimer::timeout, [this] {
         m_reached_end = false;
-        m_has_unconfirmed = false;
-        fetch(true, 0, 30);
+        fetch(true, 0, m_page_size, false);
     });
 }
 
@@ -28,9 +30,14 @@ void TransactionListModel::setAccount(Account *account)
     if (m_account) {
         beginResetModel();
         m_reached_end = false;
-        m_get_transactions_activity.update(nullptr);
+        m_prefetching = false;
+        // No longer visible, don't wait for it.
+        discardActivity();
         m_transactions.clear();
-        disconnect(m_account, &Account::notificationHandled, this, &TransactionListModel::handleNotification);
+        m_prefetched.clear();
+        disconnect(m_account, &Account::transactionEvent, this, &TransactionListModel::handleTransactionEvent);
+        disconnect(m_account, &Account::blockEvent, this, &TransactionListModel::handleBlockEvent);
+        disconnect(m_account->confirmationTracker(), &ConfirmationTracker::transactionsChanged, this, &TransactionListModel::handleTransactionsChanged);
         m_account = nullptr;
         emit accountChanged(nullptr);
         endResetModel();
@@ -39,57 +46,130 @@ void TransactionListModel::setAccount(Account *account)
     m_account = account;
     emit accountChanged(account);
     if (m_account) {
-        connect(m_account, &Account::notificationHandled, this, &TransactionListModel::handleNotification);
+        connect(m_account, &Account::transactionEvent, this, &TransactionListModel::handleTransactionEvent);
+        connect(m_account, &Account::blockEvent, this, &TransactionListModel::handleBlockEvent);
+        connect(m_account->confirmationTracker(), &ConfirmationTracker::transactionsChanged, this, &TransactionListModel::handleTransactionsChanged);
         fetchMore(QModelIndex());
     }
 }
 
-void TransactionListModel::handleNotification(const QJsonObject& notification)
+void TransactionListModel::handleTransactionEvent()
 {
-    QString event = notification.value("event").toString();
-    if (event == "transaction") {
-        reload();
-        return;
+    reload();
+}
+
+void TransactionListModel::handleBlockEvent()
+{
+    // Confirmed transactions are updated by the confirmation tracker, only
+    // refetch if some unconfirmed transaction could have been included.
+    for (auto transaction : m_transactions) {
+        if (transaction->isUnconfirmed()) {
+            reload();
+            return;
+        }
     }
+}
 
-    if (event == "block" && m_has_unconfirmed) {
-        reload();
-        return;
+void TransactionListModel::handleTransactionsChanged(const QVector<Transaction*>& transactions)
+{
+    for (auto transaction : transactions) {
+        const int row = m_transactions.indexOf(transaction);
+        if (row < 0) continue;
+        const auto index = this->index(row);
+        emit dataChanged(index, index, { Qt::UserRole });
     }
 }
 
-void TransactionListModel::fetch(bool reset, int offset, int count)
+void TransactionListModel::fetch(bool reset, int offset, int count, bool background)
 {
+    discardActivity();
     m_get_transactions_activity.update(new AccountGetTransactionsActivity(m_account, offset, count, this));
-    m_account->wallet()->pushActivity(m_get_transactions_activity);
+    m_get_transactions_activity->setBackground(background);
+    m_prefetching = background;
+    // Read ahead isn't shown as wallet activity.
+    if (!background) m_account->wallet()->pushActivity(m_get_transactions_activity);
+
+    QElapsedTimer timer;
+    timer.start();
+    m_get_transactions_activity.track(QObject::connect(m_get_transactions_activity, &Activity::finished, this, [this, reset, timer] {
+        const auto transactions = m_get_transactions_activity->transactions();
+        updatePageSize(timer.elapsed());
+        m_reached_end = transactions.size() < m_get_transactions_activity->count();
+        const bool prefetched = m_prefetching;
+
+        m_prefetching = false;
+        m_get_transactions_activity->deleteLater();
+        m_get_transactions_activity.update(nullptr);
 
-    m_get_transactions_activity.track(QObject::connect(m_get_transactions_activity, &Activity::finished, this, [this, reset] {
-        for (auto transaction : m_get_transactions_activity->transactions()) {
-            if (transaction->isUnconfirmed()) m_has_unconfirmed = true;
-        }
-        m_reached_end = m_get_transactions_activity->transactions().empty();
         if (reset) {
             // just swap rows instead of incremental update
             // this happens after a bump fee for instance
             beginResetModel();
-            m_transactions = m_get_transactions_activity->transactions();
+            m_transactions = transactions;
+            m_prefetched.clear();
             endResetModel();
+        } else if (prefetched) {
+            m_prefetched.append(transactions);
         } else {
-            // new page of transactions, just append to existing transaction
-            beginInsertRows(QModelIndex(), m_transactions.size(), m_transactions.size() + m_get_transactions_activity->transactions().size() - 1);
-            m_transactions.append(m_get_transactions_activity->transactions());
-            endInsertRows();
+            insert(transactions);
         }
 
-        m_get_transactions_activity->deleteLater();
-        m_get_transactions_activity.update(0);
         emit fetchingChanged();
+        prefetch();
     }));
+    // Failed or cancelled, for instance on logout, nothing to show. Read
+    // ahead resumes with the next fetch.
+    const auto abandon = [this] {
+        m_prefetching = false;
+        m_get_transactions_activity->deleteLater();
+        m_get_transactions_activity.update(nullptr);
+        emit fetchingChanged();
+    };
+    m_get_transactions_activity.track(QObject::connect(m_get_transactions_activity, &Activity::failed, this, abandon));
+    m_get_transactions_activity.track(QObject::connect(m_get_transactions_activity, &Activity::cancelled, this, abandon));
 
-    m_get_transactions_activity->exec();
+    m_account->wallet()->scheduler()->schedule(m_get_transactions_activity, background ? ActivityScheduler::Priority::Low : ActivityScheduler::Priority::High);
     emit fetchingChanged();
 }
 
+void TransactionListModel::discardActivity()
+{
+    // Detached before cancelling so that its handlers don't run.
+    auto activity = m_get_transactions_activity.get();
+    if (!activity) return;
+    m_get_transactions_activity.update(nullptr);
+    activity->cancel();
+    activity->deleteLater();
+}
+
+void TransactionListModel::prefetch()
+{
+    // Keep between one and two pages read ahead of the exposed rows.
+    if (!m_account || m_reached_end || m_get_transactions_activity) return;
+    if (m_prefetched.size() >= m_page_size) return;
+    fetch(false, m_transactions.size() + m_prefetched.size(), m_page_size, true);
+}
+
+void TransactionListModel::insert(const QVector<Transaction*>& transactions)
+{
+    if (transactions.isEmpty()) return;
+    // new page of transactions, just append to existing transaction
+    beginInsertRows(QModelIndex(), m_transactions.size(), m_transactions.size() + transactions.size() - 1);
+    m_transactions.append(transactions);
+    endInsertRows();
+}
+
+void TransactionListModel::updatePageSize(qint64 elapsed)
+{
+    // Slow round trips, for instance over Tor, are amortized with larger
+    // pages, fast ones keep pages small to update the view sooner.
+    if (elapsed > 1000) {
+        m_page_size = qMin(m_page_size * 2, 120);
+    } else if (elapsed < 250) {
+        m_page_size = qMax(m_page_size / 2, 30);
+    }
+}
+
 QHash<int, QByteArray> TransactionListModel::roleNames() const
 {
     return {
@@ -100,18 +180,33 @@ QHash<int, QByteArray> TransactionListModel::roleNames() const
 bool TransactionListModel::canFetchMore(const QModelIndex &parent) const
 {
     Q_ASSERT(!parent.parent().isValid());
+    if (!m_prefetched.isEmpty()) return true;
     if (m_reached_end) return false;
-    // Prevent concurrent fetchMore
-    if (m_get_transactions_activity) return false;
-    return true;
+    // Prevent concurrent fetchMore, a pending read ahead is taken over
+    return !fetching();
 }
 
 void TransactionListModel::fetchMore(const QModelIndex &parent)
 {
     Q_ASSERT(!parent.parent().isValid());
     if (!m_account) return;
-    if (m_get_transactions_activity) return;
-    fetch(false, m_transactions.size(), 30);
+    if (!m_prefetched.isEmpty()) {
+        const auto page = m_prefetched.mid(0, m_page_size);
+        m_prefetched.remove(0, page.size());
+        insert(page);
+        prefetch();
+        return;
+    }
+    if (m_get_transactions_activity) {
+        // The view caught up with the read ahead, show its rows as soon as
+        // they arrive.
+        if (m_prefetching) {
+            m_prefetching = false;
+            emit fetchingChanged();
+        }
+        return;
+    }
+    fetch(false, m_transactions.size(), m_page_size, false);
 }
 
 int TransactionListModel::rowCount(const QModelIndex &parent) const
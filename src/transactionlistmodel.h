@@ -25,7 +25,7 @@ public:
 
     Account* account() const { return m_account; }
     void setAccount(Account* account);
-    bool fetching() const { return m_get_transactions_activity; }
+    bool fetching() const { return m_get_transactions_activity && !m_prefetching; }
 
     QHash<int,QByteArray> roleNames() const override;
     void fetchMore(const QModelIndex &parent) override;
@@ -39,13 +39,22 @@ signals:
     void accountChanged(Account* account);
     void fetchingChanged();
 private slots:
-    void handleNotification(const QJsonObject& notification);
+    void handleTransactionEvent();
+    void handleBlockEvent();
+    void handleTransactionsChanged(const QVector<Transaction*>& transactions);
 private:
-    void fetch(bool reset, int offset, int count);
+    void fetch(bool reset, int offset, int count, bool background);
+    void prefetch();
+    void discardActivity();
+    void insert(const QVector<Transaction*>& transactions);
+    void updatePageSize(qint64 elapsed);
 private:
     Account* m_account{nullptr};
     QVector<Transaction*> m_transactions;
-    bool m_has_unconfirmed{false};
+    // Read ahead transactions not yet exposed as rows.
+    QVector<Transaction*> m_prefetched;
+    bool m_prefetching{false};
+    int m_page_size{30};
     bool m_reached_end{false};
     Connectable<AccountGetTransactionsActivity> m_get_transactions_activity;
     QTimer* const m_reload_timer;
@@ -2,6 +2,7 @@
 
 #include <QDir>
 #include <QCryptographicHash>
+#include <QSet>
 
 QString g_data_location;
 
@@ -70,3 +71,11 @@ QString Sha256(const QString &value)
     hash.addData(value.toLocal8Bit());
     return QString::fromLocal8Bit(hash.result().toHex());
 }
+
+QString Intern(const QString& value)
+{
+    static QSet<QString> values;
+    auto i = values.constFind(value);
+    if (i == values.constEnd()) i = values.insert(value);
+    return *i;
+}
@@ -21,4 +21,8 @@ QByteArray ReverseByteArray(const QByteArray& byte_array);
 
 QString Sha256(const QString& value);
 
+// Returns a shared copy of the given string, for values repeated across many
+// objects like transaction types and address types. Not thread safe.
+QString Intern(const QString& value);
+
 #endif // GREEN_UTIL_H
@@ -1,17 +1,21 @@
 #include "account.h"
+#include "activityscheduler.h"
 #include "asset.h"
 #include "balance.h"
 #include "ga.h"
+#include "feeestimator.h"
 #include "json.h"
 #include "createaccounthandler.h"
 #include "loginhandler.h"
 #include "network.h"
+#include "notificationbus.h"
 #include "util.h"
 #include "wallet.h"
 #include "resolver.h"
 #include "handler.h"
 #include "session.h"
 #include "walletmanager.h"
+#include "walletstore.h"
 
 #include <type_traits>
 
@@ -19,6 +23,7 @@
 #include <QDebug>
 #include <QJsonObject>
 #include <QLocale>
+#include <QSaveFile>
 #include <QSettings>
 #include <QTimer>
 #include <QUuid>
@@ -63,10 +68,20 @@ QByteArray pinDataForNewPin(GA_session* session, const QByteArray& pin)
     Q_ASSERT(err == GA_OK);
     return pin_data;
 }
+// Drops a query in flight, the handler is released once it completes.
+void abandonHandler(Connectable<Handler>& connectable)
+{
+    auto handler = connectable.get();
+    if (!handler) return;
+    connectable.update(nullptr);
+    QObject::connect(handler, &Handler::done, handler, &QObject::deleteLater);
+    QObject::connect(handler, &Handler::error, handler, &QObject::deleteLater);
+}
 } // namespace
 
 Wallet::Wallet(Network* network, QObject *parent)
     : Entity(parent)
+    , m_scheduler(new ActivityScheduler(3, this))
     , m_network(network)
 {
     QObject::connect(this, &Wallet::activitiesChanged, this, &Wallet::updateReady);
@@ -91,7 +106,15 @@ void Wallet::disconnect()
     m_settings = {};
     m_config = {};
     m_currencies = {};
+    abandonHandler(m_config_handler);
+    abandonHandler(m_settings_handler);
+    abandonHandler(m_currencies_handler);
+    m_config_pending = false;
+    m_settings_pending = false;
     m_events = {};
+    m_block_height = 0;
+    m_resync_pending = false;
+    m_resync_height = 0;
 
     setAuthentication(Unauthenticated);
 
@@ -105,6 +128,8 @@ void Wallet::disconnect()
     qDeleteAll(accounts);
     qDeleteAll(m_assets.values());
     m_assets.clear();
+    m_totals.clear();
+    m_funded_balances = 0;
 }
 
 Wallet::~Wallet()
@@ -157,44 +182,10 @@ QQmlListProperty<Account> Wallet::accounts()
     return { this, &m_accounts };
 }
 
-void Wallet::handleNotification(const QJsonObject &notification)
+void Wallet::updateEvent(const QString& event, const QJsonObject& data)
 {
-    QString event = notification.value("event").toString();
-    Q_ASSERT(!event.isEmpty());
-
-    QJsonValue data = notification.value(event);
-
-    if (data.isObject()) emit this->notification(event, data.toObject());
-
     m_events.insert(event, data);
     emit eventsChanged(m_events);
-
-    if (event == "transaction") {
-        QJsonObject transaction = data.toObject();
-        for (auto pointer : transaction.value("subaccounts").toArray()) {
-            auto account = m_accounts_by_pointer.value(pointer.toInt());
-            if (account) account->handleNotification(notification);
-        }
-        updateEmpty();
-        return;
-    }
-
-    if (event == "settings") {
-        setSettings(data.toObject());
-        return;
-    }
-
-    if (event == "twofactor_reset") {
-        setLocked(data.toObject().value("is_active").toBool());
-        return;
-    }
-
-    if (event == "block") {
-        for (auto account : m_accounts) {
-            account->handleNotification(notification);
-        }
-        return;
-    }
 }
 
 QJsonObject Wallet::events() const
@@ -226,18 +217,37 @@ void Wallet::changePin(const QByteArray& pin)
 
 void Wallet::reload()
 {
+    // Reloads requested while accounts are loading run once it's done.
+    if (m_update_accounts_activity) {
+        m_reload_pending = true;
+        return;
+    }
+
+    // Balances are only shown correctly with assets loaded.
+    QList<Activity*> dependencies;
     if (m_network->isLiquid()) {
         // Load cached assets
-        refreshAssets(false);
+        dependencies.append(refreshAssets(false));
     }
 
-    if (!m_update_accounts_activity) {
-        m_update_accounts_activity = new WalletUpdateAccountsActivity(this, this);
-        pushActivity(m_update_accounts_activity);
-    }
+    auto activity = new WalletUpdateAccountsActivity(this, this);
+    m_update_accounts_activity = activity;
+    QObject::connect(activity, &Activity::cancelled, this, [this, activity] {
+        if (m_update_accounts_activity != activity) return;
+        m_update_accounts_activity = nullptr;
+        m_reload_pending = false;
+        activity->deleteLater();
+    });
+    pushActivity(activity);
+    m_scheduler->schedule(activity, ActivityScheduler::Priority::High, dependencies);
+}
 
+void Wallet::loadAccounts()
+{
     auto handler = new GetSubAccountsHandler(this);
     QObject::connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
+        if (!m_update_accounts_activity) return;
         const bool create_segwit = m_network->isElectrum();
         bool has_segwit = false;
 
@@ -256,7 +266,7 @@ void Wallet::reload()
             auto handler = new CreateAccountHandler({{ "name", "Segwit Account" }, { "type", "p2wpkh" }}, this);
             QObject::connect(handler, &Handler::done, this, [=] {
                 handler->deleteLater();
-                reload();
+                loadAccounts();
             });
             handler->exec();
             return;
@@ -286,6 +296,11 @@ void Wallet::reload()
         m_update_accounts_activity->finish();
         m_update_accounts_activity->deleteLater();
         m_update_accounts_activity = nullptr;
+
+        if (m_reload_pending) {
+            m_reload_pending = false;
+            reload();
+        }
     });
     QObject::connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
         resolver->resolve();
@@ -322,44 +337,15 @@ public:
     }
 };
 
-void Wallet::refreshAssets(bool refresh)
+WalletRefreshAssets* Wallet::refreshAssets(bool refresh)
 {
     Q_ASSERT(m_network->isLiquid());
 
-    auto activity = new WalletRefreshAssets(this, this);
+    auto activity = new WalletRefreshAssets(refresh, this, this);
+    QObject::connect(activity, &Activity::statusChanged, activity, &QObject::deleteLater);
     pushActivity(activity);
-
-    auto handler = new RefreshAssetsHandler(refresh, this);
-    handler->exec();
-
-    connect(handler, &Handler::done, this, [this, handler, activity] {
-        handler->deleteLater();
-
-        if (handler->m_assets.empty()) {
-            activity->fail();
-            activity->deleteLater();
-            return;
-        }
-
-        auto icons = handler->m_assets.value("icons").toObject();
-
-        for (auto&& ref : handler->m_assets.value("assets").toObject()) {
-            QString id = ref.toObject().value("asset_id").toString();
-            if (id.isEmpty()) continue;
-            Asset* asset = getOrCreateAsset(id);
-            asset->setData(ref.toObject());
-            if (icons.contains(id)) {
-                asset->setIcon("data:image/png;base64," + icons.value(id).toString());
-            }
-        }
-
-        for (auto account : m_accounts) {
-            account->updateBalance();
-        }
-
-        activity->finish();
-        activity->deleteLater();
-    });
+    m_scheduler->schedule(activity);
+    return activity;
 }
 
 void Wallet::rename(QString name, bool active_focus)
@@ -386,36 +372,180 @@ void Wallet::setWatchOnly(const QString& username, const QString& password)
     emit usernameChanged(m_username);
 }
 
+class GetTwoFactorConfigHandler : public Handler
+{
+public:
+    QJsonObject m_config;
+
+    GetTwoFactorConfigHandler(Wallet* wallet)
+        : Handler(wallet)
+    {
+    }
+    void call(GA_session* session, GA_auth_handler** auth_handler) override
+    {
+        Q_UNUSED(auth_handler);
+        GA_json* config;
+        if (GA_OK != GA_get_twofactor_config(session, &config)) return;
+        m_config = Json::toObject(config);
+        GA_destroy_json(config);
+    }
+};
+
+class GetSettingsHandler : public Handler
+{
+public:
+    QJsonObject m_settings;
+
+    GetSettingsHandler(Wallet* wallet)
+        : Handler(wallet)
+    {
+    }
+    void call(GA_session* session, GA_auth_handler** auth_handler) override
+    {
+        Q_UNUSED(auth_handler);
+        GA_json* settings;
+        if (GA_OK != GA_get_settings(session, &settings)) return;
+        m_settings = Json::toObject(settings);
+        GA_destroy_json(settings);
+    }
+};
+
+class GetAvailableCurrenciesHandler : public Handler
+{
+public:
+    QJsonObject m_currencies;
+
+    GetAvailableCurrenciesHandler(Wallet* wallet)
+        : Handler(wallet)
+    {
+    }
+    void call(GA_session* session, GA_auth_handler** auth_handler) override
+    {
+        Q_UNUSED(auth_handler);
+        GA_json* currencies;
+        if (GA_OK != GA_get_available_currencies(session, &currencies)) return;
+        m_currencies = Json::toObject(currencies);
+        GA_destroy_json(currencies);
+    }
+};
+
+namespace {
+    QJsonObject ReadCache(const QString& name)
+    {
+        QFile file(GetDataFile("cache", name));
+        if (!file.open(QFile::ReadOnly)) return {};
+        return QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    void WriteCache(const QString& name, const QJsonObject& data)
+    {
+        // Replaced atomically, a crash never leaves a truncated cache.
+        QSaveFile file(GetDataFile("cache", name));
+        if (!file.open(QFile::WriteOnly)) return;
+        file.write(QJsonDocument(data).toJson(QJsonDocument::Compact));
+        if (!file.commit()) qWarning() << "failed to write cache" << name << file.errorString();
+    }
+} // namespace
+
+QString Wallet::settingsCacheName() const
+{
+    // Device wallets aren't persisted, neither are their settings.
+    if (m_id.isEmpty() || m_device) return {};
+    return QString("%1.settings.json").arg(m_id);
+}
+
+void Wallet::loadCache()
+{
+    // Served until the network answers, then replaced.
+    const auto settings_cache = settingsCacheName();
+    if (m_settings.isEmpty() && !settings_cache.isEmpty()) {
+        const auto settings = ReadCache(settings_cache);
+        if (!settings.isEmpty()) setSettings(settings);
+    }
+    if (m_currencies.isEmpty()) {
+        m_currencies = ReadCache(QString("%1.currencies.json").arg(m_network->id()));
+        if (!m_currencies.isEmpty()) emit currenciesChanged();
+    }
+}
+
 void Wallet::updateConfig()
 {
     if (m_watch_only) return;
-    GA_json* config;
-    int err = GA_get_twofactor_config(m_session->m_session, &config);
-    Q_ASSERT(err == GA_OK);
-    m_config = Json::toObject(config);
-    GA_destroy_json(config);
-    emit configChanged();
-
-    setLocked(m_config.value("twofactor_reset").toObject().value("is_active").toBool());
+    // Rerun once the running query finishes, the config may have changed.
+    if (m_config_handler) {
+        m_config_pending = true;
+        return;
+    }
+    auto handler = new GetTwoFactorConfigHandler(this);
+    m_config_handler = handler;
+    m_config_handler.track(QObject::connect(handler, &Handler::error, this, [this, handler] {
+        handler->deleteLater();
+        m_config_handler = nullptr;
+        m_config_pending = false;
+    }));
+    m_config_handler.track(QObject::connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
+        m_config_handler = nullptr;
+        if (!handler->m_config.isEmpty()) {
+            m_config = handler->m_config;
+            emit configChanged();
+            setLocked(m_config.value("twofactor_reset").toObject().value("is_active").toBool());
+        }
+        if (m_config_pending) {
+            m_config_pending = false;
+            updateConfig();
+        }
+    }));
+    handler->exec();
 }
 
 void Wallet::updateSettings()
 {
-    GA_json* settings;
-    int err = GA_get_settings(m_session->m_session, &settings);
-    Q_ASSERT(err == GA_OK);
-    auto data = Json::toObject(settings);
-    GA_destroy_json(settings);
-    setSettings(data);
+    if (m_settings_handler) {
+        m_settings_pending = true;
+        return;
+    }
+    auto handler = new GetSettingsHandler(this);
+    m_settings_handler = handler;
+    m_settings_handler.track(QObject::connect(handler, &Handler::error, this, [this, handler] {
+        handler->deleteLater();
+        m_settings_handler = nullptr;
+        m_settings_pending = false;
+    }));
+    m_settings_handler.track(QObject::connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
+        m_settings_handler = nullptr;
+        if (!handler->m_settings.isEmpty()) {
+            setSettings(handler->m_settings);
+            const auto settings_cache = settingsCacheName();
+            if (!settings_cache.isEmpty()) WriteCache(settings_cache, m_settings);
+        }
+        if (m_settings_pending) {
+            m_settings_pending = false;
+            updateSettings();
+        }
+    }));
+    handler->exec();
 }
 
 void Wallet::updateCurrencies()
 {
-    GA_json* currencies;
-    int err = GA_get_available_currencies(m_session->m_session, &currencies);
-    Q_ASSERT(err == GA_OK);
-    m_currencies = Json::toObject(currencies);
-    GA_destroy_json(currencies);
+    if (m_currencies_handler) return;
+    auto handler = new GetAvailableCurrenciesHandler(this);
+    m_currencies_handler = handler;
+    m_currencies_handler.track(QObject::connect(handler, &Handler::error, this, [this, handler] {
+        handler->deleteLater();
+        m_currencies_handler = nullptr;
+    }));
+    m_currencies_handler.track(QObject::connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
+        m_currencies_handler = nullptr;
+        if (handler->m_currencies.isEmpty() || m_currencies == handler->m_currencies) return;
+        m_currencies = handler->m_currencies;
+        emit currenciesChanged();
+        WriteCache(QString("%1.currencies.json").arg(m_network->id()), m_currencies);
+    }));
+    handler->exec();
 }
 
 void Wallet::save()
@@ -436,12 +566,7 @@ void Wallet::save()
     if (!m_hash_id.isEmpty()) {
         data.insert("hash_id", m_hash_id);
     }
-    QFile file(GetDataFile("wallets", m_id));
-    bool result = file.open(QFile::WriteOnly | QFile::Truncate);
-    Q_ASSERT(result);
-    file.write(QJsonDocument(data).toJson());
-    result = file.flush();
-    Q_ASSERT(result);
+    WalletManager::instance()->store()->update(m_id, data);
 }
 
 void Wallet::clearPinData()
@@ -451,21 +576,28 @@ void Wallet::clearPinData()
     save();
 }
 
-void Wallet::updateEmpty()
+void Wallet::resync()
 {
-    for (const auto& account : m_accounts_by_pointer.values()) {
-        if (account->balance() > 0) {
-            setEmpty(false);
-            return;
-        }
-        for (const auto& balance : account->m_balances) {
-            if (balance->amount() > 0) {
-                setEmpty(false);
-                return;
-            }
-        }
+    qDebug() << "resync" << m_accounts_by_pointer.size() << "accounts since block" << m_resync_height;
+    for (auto account : m_accounts_by_pointer.values()) {
+        account->resync(m_resync_height);
     }
-    setEmpty(true);
+}
+
+void Wallet::updateEmpty()
+{
+    setEmpty(m_funded_balances == 0);
+}
+
+void Wallet::updateTotal(const QString& id, qint64 from, qint64 to)
+{
+    if (from == to) return;
+    m_totals[id] += to - from;
+    if (from <= 0 && to > 0) ++m_funded_balances;
+    if (from > 0 && to <= 0) --m_funded_balances;
+    Q_ASSERT(m_funded_balances >= 0);
+    updateEmpty();
+    emit totalsChanged();
 }
 
 void Wallet::setEmpty(bool empty)
@@ -480,6 +612,8 @@ void Wallet::setAuthentication(AuthenticationStatus authentication)
     if (m_authentication == authentication) return;
     qDebug() << "authentication change" << m_authentication << " -> " << authentication;
     m_authentication = authentication;
+    // Scheduled work needs an authenticated session.
+    if (m_authentication == Unauthenticated) m_scheduler->cancelAll();
     emit authenticationChanged();
 }
 
@@ -544,10 +678,11 @@ Asset* Wallet::getOrCreateAsset(const QString& id)
     Q_ASSERT(m_network && m_network->isLiquid());
     Q_ASSERT(id != "btc");
 
-    Asset* asset = m_assets.value(id);
+    const auto key = HashKey::fromString(id);
+    Asset* asset = m_assets.value(key);
     if (!asset) {
         asset = new Asset(id, this);
-        m_assets.insert(id, asset);
+        m_assets.insert(key, asset);
     }
     return asset;
 }
@@ -578,11 +713,39 @@ void Wallet::setSession(Session* session)
     Q_ASSERT(session);
     m_session = session;
     Q_ASSERT(m_network == m_session->network());
-    m_session.track(QObject::connect(m_session, &Session::notificationHandled, this, &Wallet::handleNotification));
-    m_session.track(QObject::connect(m_session, &Session::networkEvent, [this](const QJsonObject& event) {
-        const bool login_required = event.value("login_required").toBool();
-        if (login_required) {
+    auto bus = m_session->bus();
+    m_session.track(QObject::connect(bus, &NotificationBus::transactionEvent, this, [this](const TransactionEvent& event) {
+        for (const int pointer : event.subaccounts) {
+            auto account = m_accounts_by_pointer.value(pointer);
+            if (account) account->handleTransactionEvent(event);
+        }
+    }));
+    m_session.track(QObject::connect(bus, &NotificationBus::blockEvent, this, [this](const BlockEvent& event) {
+        m_block_height = event.height;
+        updateEvent("block", event.data);
+        for (auto account : m_accounts) {
+            account->handleBlockEvent(event);
+        }
+    }));
+    m_session.track(QObject::connect(bus, &NotificationBus::settingsEvent, this, &Wallet::setSettings));
+    m_session.track(QObject::connect(bus, &NotificationBus::twoFactorResetEvent, this, [this](const TwoFactorResetEvent& event) {
+        updateEvent("twofactor_reset", event.data);
+        setLocked(event.active);
+    }));
+    m_session.track(QObject::connect(bus, &NotificationBus::torEvent, this, [this](const TorEvent& event) {
+        updateEvent("tor", event.data);
+    }));
+    m_session.track(QObject::connect(bus, &NotificationBus::networkEvent, this, [this](const NetworkEvent& event) {
+        if (event.loginRequired) {
+            m_resync_pending = false;
             setAuthentication(Unauthenticated);
+        } else if (!event.connected) {
+            // Only the first of repeated disconnections sets the height.
+            if (!m_resync_pending) m_resync_height = m_block_height;
+            m_resync_pending = isAuthenticated();
+        } else if (m_resync_pending) {
+            m_resync_pending = false;
+            resync();
         }
     }));
     emit sessionChanged(m_session);
@@ -591,6 +754,7 @@ void Wallet::setSession(Session* session)
 void Wallet::setSession()
 {
     setAuthentication(Authenticated);
+    loadCache();
     updateSettings();
     updateCurrencies();
     updateConfig();
@@ -685,13 +849,45 @@ void WalletAuthenticateActivity::exec()
 {
 }
 
-WalletRefreshAssets::WalletRefreshAssets(Wallet* wallet, QObject* parent)
+WalletRefreshAssets::WalletRefreshAssets(bool refresh, Wallet* wallet, QObject* parent)
     : WalletActivity(wallet, parent)
+    , m_refresh(refresh)
+{
+}
+
+QString WalletRefreshAssets::key() const
 {
+    return QString("refresh_assets:%1").arg(int(m_refresh));
 }
 
 void WalletRefreshAssets::exec()
 {
+    auto handler = new RefreshAssetsHandler(m_refresh, wallet());
+    QObject::connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
+        if (status() == Status::Cancelled) return;
+
+        if (handler->m_assets.empty()) return fail();
+
+        auto icons = handler->m_assets.value("icons").toObject();
+
+        for (auto&& ref : handler->m_assets.value("assets").toObject()) {
+            QString id = ref.toObject().value("asset_id").toString();
+            if (id.isEmpty()) continue;
+            Asset* asset = wallet()->getOrCreateAsset(id);
+            asset->setData(ref.toObject());
+            if (icons.contains(id)) {
+                asset->setIcon("data:image/png;base64," + icons.value(id).toString());
+            }
+        }
+
+        for (auto account : wallet()->m_accounts) {
+            account->sortBalances();
+        }
+
+        finish();
+    });
+    handler->exec();
 }
 
 WalletUpdateAccountsActivity::WalletUpdateAccountsActivity(Wallet* wallet, QObject* parent)
@@ -702,6 +898,7 @@ WalletUpdateAccountsActivity::WalletUpdateAccountsActivity(Wallet* wallet, QObje
 
 void WalletUpdateAccountsActivity::exec()
 {
+    wallet()->loadAccounts();
 }
 
 WalletSignupActivity::WalletSignupActivity(Wallet *wallet, QObject *parent)
@@ -771,6 +968,7 @@ void LoginWithPinController::update()
         }
         m_wallet->updateHashId(handler->walletHashId());
         m_wallet->setAuthentication(Wallet::Authenticated);
+        m_wallet->loadCache();
         m_wallet->updateCurrencies();
         m_wallet->updateSettings();
         m_wallet->reload();
@@ -821,30 +1019,37 @@ QByteArray SetPinHandler::pinData() const
 FeeEstimates::FeeEstimates(QObject* parent) :
     QObject(parent)
 {
-    connect(&m_update_timer, &QTimer::timeout, this, &FeeEstimates::update);
+}
+
+FeeEstimates::~FeeEstimates()
+{
+    if (m_estimator && m_wallet) m_estimator->removeWallet(m_wallet);
 }
 
 void FeeEstimates::setWallet(Wallet* wallet)
 {
-    if (!m_wallet.update(wallet)) return;
-    if (m_wallet) {
-        update();
-        m_update_timer.start(120000);
-    } else {
-        m_update_timer.stop();
+    if (m_wallet == wallet) return;
+    if (m_estimator && m_wallet) m_estimator->removeWallet(m_wallet);
+    m_wallet.update(wallet);
+    m_estimator.update(wallet ? FeeEstimator::instance(wallet->network()) : nullptr);
+    if (m_estimator) {
+        m_estimator.track(connect(m_estimator, &FeeEstimator::feesChanged, this, &FeeEstimates::feesChanged));
+        m_estimator.track(connect(m_estimator, &FeeEstimator::historyChanged, this, &FeeEstimates::historyChanged));
+        // Wallets can only be used once logged in.
+        m_wallet.track(connect(wallet, &Wallet::authenticationChanged, m_estimator, &FeeEstimator::update));
+        m_estimator->addWallet(wallet);
     }
+    emit walletChanged(m_wallet);
+    emit feesChanged(fees());
+    emit historyChanged();
 }
 
-void FeeEstimates::update()
+QJsonArray FeeEstimates::fees() const
 {
-    if (!m_wallet->session()) return;
-    GA_json* estimates;
-    if (GA_OK == GA_get_fee_estimates(m_wallet->session()->m_session, &estimates)) {
-        const auto fees = Json::toObject(estimates).value("fees").toArray();
-        GA_destroy_json(estimates);
-        if (m_fees != fees) {
-            m_fees = fees;
-            emit feesChanged(m_fees);
-        }
-    }
+    return m_estimator ? m_estimator->fees() : QJsonArray();
+}
+
+QJsonArray FeeEstimates::history() const
+{
+    return m_estimator ? m_estimator->historyJson() : QJsonArray();
 }
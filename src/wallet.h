@@ -3,6 +3,7 @@
 
 #include "activity.h"
 #include "connectable.h"
+#include "hashkey.h"
 #include "session.h"
 
 #include <QtQml>
@@ -14,10 +15,13 @@
 #include <QJsonObject>
 
 class Account;
+class ActivityScheduler;
 class Asset;
 class Device;
+class FeeEstimator;
 class Network;
 class Session;
+class WalletRefreshAssets;
 class WalletUpdateAccountsActivity;
 
 struct GA_session;
@@ -60,7 +64,7 @@ private:
     Q_PROPERTY(bool ready READ ready NOTIFY readyChanged)
     Q_PROPERTY(bool locked READ isLocked NOTIFY lockedChanged)
     Q_PROPERTY(QJsonObject settings READ settings NOTIFY settingsChanged)
-    Q_PROPERTY(QJsonObject currencies READ currencies CONSTANT)
+    Q_PROPERTY(QJsonObject currencies READ currencies NOTIFY currenciesChanged)
     Q_PROPERTY(QQmlListProperty<Account> accounts READ accounts NOTIFY accountsChanged)
     Q_PROPERTY(QJsonObject events READ events NOTIFY eventsChanged)
     Q_PROPERTY(QStringList mnemonic READ mnemonic CONSTANT)
@@ -68,6 +72,7 @@ private:
     Q_PROPERTY(QJsonObject config READ config NOTIFY configChanged)
     Q_PROPERTY(Device* device READ device CONSTANT)
     Q_PROPERTY(bool empty READ isEmpty NOTIFY emptyChanged)
+    Q_PROPERTY(ActivityScheduler* scheduler READ scheduler CONSTANT)
 public:
     explicit Wallet(Network* network, QObject *parent = nullptr);
     virtual ~Wallet();
@@ -91,9 +96,8 @@ public:
 
     QQmlListProperty<Account> accounts();
 
-    void handleNotification(const QJsonObject& notification);
-
     QJsonObject events() const;
+    quint32 blockHeight() const { return m_block_height; }
 
     QStringList mnemonic() const;
 
@@ -111,6 +115,9 @@ public:
     Q_INVOKABLE QString formatAmount(qint64 amount, bool include_ticker, const QString& unit) const;
 
     Q_INVOKABLE Asset* getOrCreateAsset(const QString& id);
+    // Sum of the given asset across all accounts, "btc" on bitcoin networks.
+    Q_INVOKABLE qint64 total(const QString& id) const { return m_totals.value(id); }
+    QHash<QString, qint64> totals() const { return m_totals; }
 
     Account* getOrCreateAccount(const QJsonObject& data);
 
@@ -118,6 +125,7 @@ public:
     void setSession();
 
     Device* device() const { return m_device; }
+    ActivityScheduler* scheduler() const { return m_scheduler; }
 
     void updateHashId(const QString& hash_id);
 public slots:
@@ -127,7 +135,7 @@ public slots:
     void updateConfig();
     void updateSettings();
 
-    void refreshAssets(bool refresh);
+    WalletRefreshAssets* refreshAssets(bool refresh);
 
     void rename(QString name, bool active_focus);
     void setWatchOnly(const QString& username, const QString& password);
@@ -137,34 +145,51 @@ signals:
     void hasPinDataChanged();
     void authenticationChanged();
     void lockedChanged(bool locked);
-    void notification(const QString& type, const QJsonObject& data);
     void accountsChanged();
     void eventsChanged(QJsonObject events);
     void nameChanged(QString name);
     void loginAttemptsRemainingChanged(int loginAttemptsRemaining);
     void settingsChanged();
+    void currenciesChanged();
     void configChanged();
     void pinSet();
     void emptyChanged(bool empty);
+    void totalsChanged();
     void usernameChanged(const QString& username);
 protected:
     bool eventFilter(QObject* object, QEvent* event) override;
     void timerEvent(QTimerEvent* event) override;
 private:
+    void resync();
     void updateEmpty();
     void setEmpty(bool empty);
+    void updateEvent(const QString& event, const QJsonObject& data);
 private:
     bool m_ready{false};
     bool m_empty{true};
+    // Totals by asset id and the number of account balances above zero,
+    // maintained from the balance updates of each account.
+    QHash<QString, qint64> m_totals;
+    int m_funded_balances{0};
+    bool m_resync_pending{false};
+    // Last block seen before the connection dropped.
+    quint32 m_resync_height{0};
 public:
     void setAuthentication(AuthenticationStatus authentication);
+    void updateTotal(const QString& id, qint64 from, qint64 to);
     void setSettings(const QJsonObject& settings);
     void updateCurrencies();
+    // Loads settings and currencies cached on disk by a previous session.
+    void loadCache();
+    QString settingsCacheName() const;
 
     QString m_id;
     QString m_hash_id;
     bool m_restoring{false};
     WalletUpdateAccountsActivity* m_update_accounts_activity{nullptr};
+    bool m_reload_pending{false};
+    void loadAccounts();
+    ActivityScheduler* const m_scheduler;
 
     Connectable<Session> m_session;
     AuthenticationStatus m_authentication{Unauthenticated};
@@ -172,8 +197,15 @@ public:
     QJsonObject m_settings;
     QJsonObject m_config;
     QJsonObject m_currencies;
+    // Queries in flight, requested again while running when pending.
+    Connectable<Handler> m_config_handler;
+    Connectable<Handler> m_settings_handler;
+    Connectable<Handler> m_currencies_handler;
+    bool m_config_pending{false};
+    bool m_settings_pending{false};
     QJsonObject m_events;
-    QMap<QString, Asset*> m_assets;
+    quint32 m_block_height{0};
+    QHash<HashKey, Asset*> m_assets;
     QList<Account*> m_accounts;
     QMap<int, Account*> m_accounts_by_pointer;
 
@@ -242,8 +274,11 @@ class WalletRefreshAssets : public WalletActivity
     Q_OBJECT
     QML_ELEMENT
 public:
-    WalletRefreshAssets(Wallet* wallet, QObject* parent);
+    WalletRefreshAssets(bool refresh, Wallet* wallet, QObject* parent);
     void exec() override;
+    QString key() const override;
+private:
+    const bool m_refresh;
 };
 
 class LoginWithPinController : public Entity
@@ -274,21 +309,22 @@ class FeeEstimates : public QObject
     Q_OBJECT
     Q_PROPERTY(Wallet* wallet READ wallet WRITE setWallet NOTIFY walletChanged)
     Q_PROPERTY(QJsonArray fees READ fees NOTIFY feesChanged)
+    Q_PROPERTY(QJsonArray history READ history NOTIFY historyChanged)
     QML_ELEMENT
 public:
     FeeEstimates(QObject* parent = nullptr);
+    virtual ~FeeEstimates();
     Wallet* wallet() const { return m_wallet; }
     void setWallet(Wallet* wallet);
-    QJsonArray fees() const { return m_fees; }
+    QJsonArray fees() const;
+    QJsonArray history() const;
 signals:
     void walletChanged(Wallet* wallet);
     void feesChanged(const QJsonArray& fees);
-private slots:
-    void update();
+    void historyChanged();
 private:
     Connectable<Wallet> m_wallet;
-    QJsonArray m_fees;
-    QTimer m_update_timer;
+    Connectable<FeeEstimator> m_estimator;
 };
 
 #endif // GREEN_WALLET_H
@@ -7,7 +7,7 @@ WalletListModel::WalletListModel(QObject* parent)
     : QSortFilterProxyModel(parent)
 {
     update();
-    m_source_model.setItemRoleNames({{ Qt::UserRole, "wallet" }});
+    m_source_model.setItemRoleNames({{ WalletRole, "wallet" }});
     connect(WalletManager::instance(), &WalletManager::changed, this, &WalletListModel::update);
     setSourceModel(&m_source_model);
     setDynamicSortFilter(true);
@@ -18,7 +18,7 @@ WalletListModel::WalletListModel(QObject* parent)
 int WalletListModel::indexOf(Wallet *wallet) const
 {
     for (int i = 0; i < rowCount(); ++i) {
-        if (data(index(i, 0), Qt::UserRole).value<Wallet*>() == wallet) return i;
+        if (data(index(i, 0), WalletRole).value<Wallet*>() == wallet) return i;
     }
     return -1;
 }
@@ -39,41 +39,59 @@ void WalletListModel::update()
         auto item = items.take(wallet);
         if (!item) {
             item = new QStandardItem;
-            item->setData(QVariant::fromValue(wallet), Qt::UserRole);
+            item->setData(QVariant::fromValue(wallet), WalletRole);
+            m_items.insert(wallet, item);
+            updateItem(wallet);
             m_source_model.appendRow(item);
-            connect(wallet, &Wallet::readyChanged, this, [this] { invalidateFilter(); });
-            connect(wallet, &Wallet::authenticationChanged, this, [this] { invalidateFilter(); });
+            connect(wallet, &Wallet::readyChanged, this, [this, wallet] { updateItem(wallet); });
+            connect(wallet, &Wallet::authenticationChanged, this, [this, wallet] { updateItem(wallet); });
+            connect(wallet, &Wallet::nameChanged, this, [this, wallet] { updateItem(wallet); });
+        } else {
+            m_items.insert(wallet, item);
         }
-        m_items.insert(wallet, item);
     }
-    for (auto item : items.values()) {
-        m_source_model.takeRow(item->row());
+    for (auto i = items.begin(); i != items.end(); ++i) {
+        disconnect(i.key(), nullptr, this, nullptr);
+        m_source_model.takeRow(i.value()->row());
     }
     qDeleteAll(items.values());
 }
 
+void WalletListModel::updateItem(Wallet* wallet)
+{
+    auto item = m_items.value(wallet);
+    if (!item) return;
+    // Unchanged values don't emit, so the proxy only revisits this row when
+    // a key actually changed.
+    item->setData(wallet->name(), NameRole);
+    item->setData(wallet->network()->key(), NetworkRole);
+    item->setData(wallet->network()->name(), NetworkNameRole);
+    item->setData(wallet->isAuthenticated(), AuthenticatedRole);
+    item->setData(wallet->ready(), ReadyRole);
+    item->setData(wallet->m_device != nullptr, DeviceRole);
+    item->setData(wallet->m_watch_only, WatchOnlyRole);
+}
+
 bool WalletListModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-    auto wallet = m_source_model.index(source_row, 0, source_parent).data(Qt::UserRole).value<Wallet*>();
-    if (!m_network.isEmpty() && wallet->network()->key() != m_network) return false;
-    if (m_just_authenticated && !wallet->isAuthenticated()) return false;
-    if (m_just_ready && !wallet->ready()) return false;
-    if (m_without_device && wallet->m_device) return false;
-    if (m_watch_only == Filter::Yes && !wallet->m_watch_only) return false;
-    if (m_watch_only == Filter::No && wallet->m_watch_only) return false;
-    return filterRegExp().indexIn(wallet->name()) >= 0;
+    const auto index = m_source_model.index(source_row, 0, source_parent);
+    if (!m_network.isEmpty() && index.data(NetworkRole).toString() != m_network) return false;
+    if (m_just_authenticated && !index.data(AuthenticatedRole).toBool()) return false;
+    if (m_just_ready && !index.data(ReadyRole).toBool()) return false;
+    if (m_without_device && index.data(DeviceRole).toBool()) return false;
+    const bool watch_only = index.data(WatchOnlyRole).toBool();
+    if (m_watch_only == Filter::Yes && !watch_only) return false;
+    if (m_watch_only == Filter::No && watch_only) return false;
+    return filterRegExp().indexIn(index.data(NameRole).toString()) >= 0;
 }
 
 bool WalletListModel::lessThan(const QModelIndex& source_left, const QModelIndex& source_right) const
 {
-    auto wallet_left = source_left.data(Qt::UserRole).value<Wallet*>();
-    auto wallet_right = source_right.data(Qt::UserRole).value<Wallet*>();
-    auto network_left = wallet_left->network();
-    auto network_right = wallet_right->network();
-    if (network_left == network_right) {
-        return QString::localeAwareCompare(wallet_left->name(), wallet_right->name()) < 0;
+    const int network = QString::localeAwareCompare(source_left.data(NetworkNameRole).toString(), source_right.data(NetworkNameRole).toString());
+    if (network == 0) {
+        return QString::localeAwareCompare(source_left.data(NameRole).toString(), source_right.data(NameRole).toString()) < 0;
     }
-    return QString::localeAwareCompare(network_left->name(), network_right->name()) < 0;
+    return network < 0;
 }
 
 void WalletListModel::setJustAuthenticated(bool just_authenticated)
@@ -26,6 +26,19 @@ public:
     };
     Q_ENUM(Filter)
 
+    // Filter and sort keys are cached in the source items, so that a wallet
+    // state change only updates and re-evaluates its own row.
+    enum Role {
+        WalletRole = Qt::UserRole,
+        NameRole,
+        NetworkRole,
+        NetworkNameRole,
+        AuthenticatedRole,
+        ReadyRole,
+        DeviceRole,
+        WatchOnlyRole,
+    };
+
     WalletListModel(QObject* parent = nullptr);
     Q_INVOKABLE int indexOf(Wallet* wallet) const;
     QString network() const { return m_network; }
@@ -46,6 +59,8 @@ signals:
     void watchOnlyChanged(Filter watch_only);
 private slots:
     void update();
+private:
+    void updateItem(Wallet* wallet);
 protected:
     bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const override;
     bool lessThan(const QModelIndex& source_left, const QModelIndex& source_right) const override;
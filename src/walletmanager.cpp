@@ -6,6 +6,7 @@
 #include "util.h"
 #include "wallet.h"
 #include "walletmanager.h"
+#include "walletstore.h"
 
 #include <QDir>
 #include <QJsonDocument>
@@ -14,7 +15,6 @@
 #include <QStandardPaths>
 #include <QUrl>
 #include <QUrlQuery>
-#include <QDirIterator>
 #include <QUuid>
 
 #include <gdk.h>
@@ -22,6 +22,7 @@
 static WalletManager* g_wallet_manager{nullptr};
 
 WalletManager::WalletManager()
+    : m_store(new WalletStore(this))
 {
     Q_ASSERT(!g_wallet_manager);
     g_wallet_manager = this;
@@ -29,19 +30,13 @@ WalletManager::WalletManager()
     auto config = Json::fromObject({{ "datadir", GetDataDir("gdk") }});
     GA_init(config.get());
 
-    QDirIterator it(GetDataDir("wallets"));
-    while (it.hasNext()) {
-        QFile file(it.next());
-        if (!file.open(QFile::ReadOnly)) continue;
-        QJsonParseError parser_error;
-        auto doc = QJsonDocument::fromJson(file.readAll(), &parser_error);
-        if (parser_error.error != QJsonParseError::NoError) continue;
-        if (!doc.isObject()) continue;
-        auto data = doc.object();
+    const auto wallets = m_store->wallets();
+    for (auto i = wallets.begin(); i != wallets.end(); ++i) {
+        const auto& data = i.value();
         auto network = NetworkManager::instance()->network(data.value("network").toString());
         if (!network) continue;
         Wallet* wallet = new Wallet(network, this);
-        wallet->m_id = QFileInfo(file).baseName();
+        wallet->m_id = i.key();
         if (data.contains("pin_data")) {
             wallet->m_pin_data = QByteArray::fromBase64(data.value("pin_data").toString().toLocal8Bit());
             wallet->m_login_attempts_remaining = data.value("login_attempts_remaining").toInt();
@@ -88,7 +83,6 @@ Wallet *WalletManager::restoreWallet(Network *network)
 void WalletManager::insertWallet(Wallet* wallet)
 {
     Q_ASSERT(!wallet->m_id.isEmpty() && !wallet->m_pin_data.isEmpty());
-    QFile file(GetDataFile("wallets", wallet->m_id));
     addWallet(wallet);
     wallet->save();
 }
@@ -100,8 +94,8 @@ void WalletManager::removeWallet(Wallet* wallet)
     m_wallets.removeOne(wallet);
     emit changed();
     if (!wallet->m_id.isEmpty() && !wallet->m_device) {
-        bool result = QFile::remove(GetDataFile("wallets", wallet->m_id));
-        Q_ASSERT(result);
+        m_store->remove(wallet->m_id);
+        QFile::remove(GetDataFile("cache", wallet->settingsCacheName()));
     }
     wallet->deleteLater();
 }
@@ -8,6 +8,7 @@
 
 QT_FORWARD_DECLARE_CLASS(Network)
 QT_FORWARD_DECLARE_CLASS(Wallet)
+QT_FORWARD_DECLARE_CLASS(WalletStore)
 
 class WalletManager : public QObject
 {
@@ -28,6 +29,7 @@ public:
     Q_INVOKABLE void removeWallet(Wallet* wallet);
 
     QQmlListProperty<Wallet> wallets();
+    WalletStore* store() const { return m_store; }
 
     QString newWalletName(Network* network) const;
     QString uniqueWalletName(const QString& base) const;
@@ -40,6 +42,7 @@ signals:
 public slots:
     QJsonObject parseUrl(const QString &url);
 public:
+    WalletStore* const m_store;
     QVector<Wallet*> m_wallets;
 };
 
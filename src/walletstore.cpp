@@ -0,0 +1,142 @@
+#include "util.h"
+#include "walletstore.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+namespace {
+    const int VERSION = 1;
+} // namespace
+
+WalletStore::WalletStore(QObject* parent)
+    : QObject(parent)
+{
+    m_save_timer.setSingleShot(true);
+    m_save_timer.setInterval(1000);
+    connect(&m_save_timer, &QTimer::timeout, this, &WalletStore::flush);
+    load();
+}
+
+WalletStore::~WalletStore()
+{
+    if (m_needs_save) flush();
+}
+
+void WalletStore::update(const QString& id, const QJsonObject& data)
+{
+    Q_ASSERT(!id.isEmpty());
+    const auto current = m_wallets.value(id);
+    if (current == data) return;
+    m_wallets.insert(id, data);
+    // Losing these to a crash would allow extra pin attempts or lose access.
+    if (current.value("login_attempts_remaining") != data.value("login_attempts_remaining") ||
+        current.value("pin_data") != data.value("pin_data")) {
+        flush();
+    } else {
+        m_needs_save = true;
+        m_save_timer.start();
+    }
+}
+
+void WalletStore::remove(const QString& id)
+{
+    if (m_wallets.remove(id) == 0) return;
+    flush();
+}
+
+void WalletStore::flush()
+{
+    m_save_timer.stop();
+    m_needs_save = false;
+    write();
+}
+
+void WalletStore::load()
+{
+    QFile file(GetDataFile("app", "wallets.json"));
+    if (!file.exists()) return migrate();
+    if (!file.open(QFile::ReadOnly)) {
+        // The store is still there, writing would replace it with only the
+        // wallets added in this session.
+        qWarning() << "failed to open wallet store, changes won't be saved" << file.errorString();
+        m_writable = false;
+        return;
+    }
+    QJsonParseError parser_error;
+    const auto doc = QJsonDocument::fromJson(file.readAll(), &parser_error);
+    file.close();
+    if (parser_error.error != QJsonParseError::NoError || !doc.isObject()) {
+        qWarning() << "failed to parse wallet store" << parser_error.errorString();
+        // Keep the damaged store for recovery and start over from whatever
+        // per wallet files are left.
+        const auto path = QString("%1.corrupt-%2").arg(file.fileName(), QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+        if (!file.rename(path)) {
+            qWarning() << "failed to move wallet store aside, changes won't be saved" << file.errorString();
+            m_writable = false;
+            return;
+        }
+        qWarning() << "moved damaged wallet store to" << path;
+        return migrate();
+    }
+    const auto wallets = doc.object().value("wallets").toObject();
+    for (auto i = wallets.begin(); i != wallets.end(); ++i) {
+        m_wallets.insert(i.key(), i.value().toObject());
+    }
+}
+
+void WalletStore::migrate()
+{
+    // Wallets used to be saved in one file each.
+    QStringList paths;
+    QDirIterator it(GetDataDir("wallets"));
+    while (it.hasNext()) {
+        QFile file(it.next());
+        if (!file.open(QFile::ReadOnly)) continue;
+        QJsonParseError parser_error;
+        auto doc = QJsonDocument::fromJson(file.readAll(), &parser_error);
+        if (parser_error.error != QJsonParseError::NoError) continue;
+        if (!doc.isObject()) continue;
+        m_wallets.insert(QFileInfo(file).baseName(), doc.object());
+        paths.append(file.fileName());
+    }
+    if (paths.isEmpty()) return;
+    // Old files are only removed once the store is safely written.
+    if (!write()) return;
+    for (const auto& path : paths) {
+        QFile::remove(path);
+    }
+    qInfo() << "migrated" << paths.size() << "wallets to wallet store";
+}
+
+bool WalletStore::write()
+{
+    if (!m_writable) {
+        qWarning() << "wallet store wasn't loaded, skipping write";
+        return false;
+    }
+    QJsonObject wallets;
+    for (auto i = m_wallets.begin(); i != m_wallets.end(); ++i) {
+        wallets.insert(i.key(), i.value());
+    }
+    const QJsonObject data{
+        { "version", VERSION },
+        { "wallets", wallets }
+    };
+    // Written to a temporary file and renamed over the store on commit.
+    QSaveFile file(GetDataFile("app", "wallets.json"));
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "failed to open wallet store for writing";
+        return false;
+    }
+    file.write(QJsonDocument(data).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning() << "failed to write wallet store" << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef GREEN_WALLETSTORE_H
+#define GREEN_WALLETSTORE_H
+
+#include <QJsonObject>
+#include <QMap>
+#include <QObject>
+#include <QTimer>
+
+// Metadata of all wallets in a single file, replaced atomically on each
+// write so that a crash leaves either the previous or the new contents.
+// Updates are batched, except for pin data and login attempts which are
+// written before returning.
+class WalletStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WalletStore(QObject* parent = nullptr);
+    virtual ~WalletStore();
+    QMap<QString, QJsonObject> wallets() const { return m_wallets; }
+    void update(const QString& id, const QJsonObject& data);
+    void remove(const QString& id);
+    void flush();
+private:
+    void load();
+    void migrate();
+    bool write();
+    QMap<QString, QJsonObject> m_wallets;
+    QTimer m_save_timer;
+    bool m_needs_save{false};
+    // Cleared when an existing store couldn't be read, so that it isn't
+    // overwritten with partial contents.
+    bool m_writable{true};
+};
+
+#endif // GREEN_WALLETSTORE_H
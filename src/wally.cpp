@@ -1,30 +1,7 @@
+#include "bip39.h"
 #include "wally.h"
 
 #include <QRandomGenerator>
-#include <QSet>
-#include <wally_bip39.h>
-
-namespace {
-
-QStringList GetWordlist()
-{
-    QStringList wordlist;
-    words* ws;
-    bip39_get_wordlist(nullptr, &ws);
-    wordlist.reserve(BIP39_WORDLIST_LEN);
-    for (size_t i = 0; i < BIP39_WORDLIST_LEN; ++i) {
-        char* w;
-        bip39_get_word(ws, i, &w);
-        wordlist.append(QString::fromLatin1(w));
-        wally_free_string(w);
-    }
-    return wordlist;
-}
-
-QStringList g_wordlist{GetWordlist()};
-QSet<QString> g_wordset{g_wordlist.begin(), g_wordlist.end()};
-
-} // namespace
 
 MnemonicEditorController::MnemonicEditorController(QObject *parent) : QObject(parent) {
     for (int i = 0; i < 27; i++) {
@@ -158,14 +135,12 @@ Word::Word(MnemonicEditorController* controller, int index)
 bool Word::setText(QString text) {
     if (m_text == text) return false;
 
+    const auto wordlist = Bip39Wordlist::instance();
+
     // A suggestion is a word with same start as input text.
     QStringList suggestions;
     if (text.length() > 1) {
-        for (QString word : g_wordlist) {
-            if (word.startsWith(text)) {
-                suggestions.append(word);
-            }
-        }
+        suggestions = wordlist->words(wordlist->range(text));
     }
     // Handle auto complete only if match is unique
     // and if new text increments current text so that
@@ -180,7 +155,7 @@ bool Word::setText(QString text) {
         m_suggestions = suggestions;
         emit suggestionsChanged();
     }
-    bool valid = g_wordset.contains(text);
+    bool valid = wordlist->contains(text);
     if (m_valid != valid) {
         m_valid = valid;
         emit validChanged(m_valid);